@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/animation.h"
+#include "slope/figure_p.h"
+#include "slope/encode_p.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <cairo.h>
+
+#if defined(_WIN32)
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+
+/**
+ */
+struct _slope_animation
+{
+    slope_figure_t *figure;
+    cairo_surface_t *surf;
+    slope_frame_format_t format;
+    int fd;
+    int nframes;
+    unsigned char *row;
+};
+
+
+slope_animation_t* slope_animation_create (slope_figure_t *figure,
+                                           int width, int height,
+                                           slope_frame_format_t format,
+                                           int fd)
+{
+    if (figure == NULL || width < 1 || height < 1 || fd < 0) return NULL;
+    cairo_surface_t *surf = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(surf) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surf);
+        return NULL;
+    }
+    slope_animation_t *animation = malloc(sizeof(slope_animation_t));
+    unsigned char *row = format == SLOPE_FRAME_RGBA ? malloc(4*width) : NULL;
+    if (animation == NULL || (format == SLOPE_FRAME_RGBA && row == NULL)) {
+        free(row);
+        free(animation);
+        cairo_surface_destroy(surf);
+        return NULL;
+    }
+    animation->figure = figure;
+    animation->surf = surf;
+    animation->format = format;
+    animation->fd = fd;
+    animation->nframes = 0;
+    animation->row = row;
+    return animation;
+}
+
+
+void slope_animation_destroy (slope_animation_t *animation)
+{
+    if (animation == NULL) return;
+    cairo_surface_destroy(animation->surf);
+    free(animation->row);
+    free(animation);
+}
+
+
+static int __slope_animation_write (int fd, const unsigned char *data,
+                                    size_t size)
+{
+    while (size > 0) {
+#if defined(_WIN32)
+        int n = _write(fd, data, (unsigned int) size);
+#else
+        ssize_t n = write(fd, data, size);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return SLOPE_ERROR;
+        }
+        data += n;
+        size -= (size_t) n;
+    }
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_animation_write_frame (slope_animation_t *animation)
+{
+    if (animation == NULL) return SLOPE_ERROR;
+    cairo_surface_t *surf = animation->surf;
+    const int width = cairo_image_surface_get_width(surf);
+    const int height = cairo_image_surface_get_height(surf);
+    const int stride = cairo_image_surface_get_stride(surf);
+    unsigned char *data;
+    int y;
+
+    /* start from transparent pixels, figures may not fill the
+       background */
+    cairo_surface_flush(surf);
+    data = cairo_image_surface_get_data(surf);
+    memset(data, 0, (size_t) stride*height);
+    cairo_surface_mark_dirty(surf);
+    /* one band, concurrent bands can't use the item layers that
+       spare redrawing what didn't change since the last frame */
+    __slope_figure_draw_image(animation->figure, surf, 1);
+    cairo_surface_flush(surf);
+
+    if (animation->format == SLOPE_FRAME_NATIVE && stride == 4*width) {
+        if (__slope_animation_write(animation->fd, data,
+                                    (size_t) stride*height) != SLOPE_SUCCESS) {
+            return SLOPE_ERROR;
+        }
+    }
+    else {
+        for (y=0; y<height; y++) {
+            const unsigned char *src = data + (size_t) y*stride;
+            if (animation->format == SLOPE_FRAME_RGBA) {
+                __slope_encode_rgba_row(src, animation->row, width);
+                src = animation->row;
+            }
+            if (__slope_animation_write(animation->fd, src,
+                                        4*width) != SLOPE_SUCCESS) {
+                return SLOPE_ERROR;
+            }
+        }
+    }
+    animation->nframes += 1;
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_animation_get_frame_count (const slope_animation_t *animation)
+{
+    if (animation == NULL) return 0;
+    return animation->nframes;
+}
+
+/* slope/animation.c */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_ANIMATION_H
+#define SLOPE_ANIMATION_H
+
+#include "slope/figure.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Byte layout of the frames written by an animation.
+ */
+typedef enum _slope_frame_format
+{
+    /* r, g, b, a bytes with straight alpha, "rgba" for ffmpeg */
+    SLOPE_FRAME_RGBA   = 0,
+    /* cairo's premultiplied ARGB32 words as they are in memory, no
+       conversion at all, "bgra" for ffmpeg on little endian hosts */
+    SLOPE_FRAME_NATIVE = 1
+}
+slope_frame_format_t;
+
+/**
+ * Writes a figure as a sequence of raw video frames, e.g. into a
+ * pipe to an encoder. The figure is drawn on the calling thread
+ * into the same image surface every frame, and items whose data
+ * didn't change reuse their cached layers.
+ */
+typedef struct _slope_animation slope_animation_t;
+
+
+/**
+ * @brief Creates an animation of width x height frames written to
+ * the file descriptor fd, which is not closed by the animation.
+ * @return The new animation, or NULL if the arguments are invalid or
+ * memory is short.
+ */
+slope_public slope_animation_t*
+slope_animation_create (slope_figure_t *figure, int width, int height,
+                        slope_frame_format_t format, int fd);
+
+/**
+ * @brief Draws the figure as it is now and writes it as one frame.
+ * @return SLOPE_SUCCESS, or SLOPE_ERROR if the frame couldn't be
+ * written completely.
+ */
+slope_public int
+slope_animation_write_frame (slope_animation_t *animation);
+
+/**
+ */
+slope_public int
+slope_animation_get_frame_count (const slope_animation_t *animation);
+
+/**
+ */
+slope_public void
+slope_animation_destroy (slope_animation_t *animation);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_ANIMATION_H */
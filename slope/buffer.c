@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOPE_BUFFER_MIN_ALLOC 4096
+
+
+static int __slope_buffer_realloc (slope_buffer_t *buffer, size_t nalloc)
+{
+    unsigned char *data = realloc(buffer->data, nalloc);
+    if (data == NULL) return SLOPE_ERROR;
+    buffer->data = data;
+    buffer->nalloc = nalloc;
+    return SLOPE_SUCCESS;
+}
+
+
+slope_buffer_t* slope_buffer_create (size_t size)
+{
+    slope_buffer_t *buffer = malloc(sizeof(slope_buffer_t));
+    if (buffer == NULL) return NULL;
+    buffer->data = NULL;
+    buffer->nalloc = 0;
+    buffer->size = 0;
+    if (size > 0 && __slope_buffer_realloc(buffer, size) != SLOPE_SUCCESS) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+
+void slope_buffer_destroy (slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return;
+    free(buffer->data);
+    free(buffer);
+}
+
+
+int slope_buffer_append (slope_buffer_t *buffer,
+                         const void *data, size_t size)
+{
+    if (buffer == NULL) return SLOPE_ERROR;
+    if (size == 0) return SLOPE_SUCCESS;
+    size_t needed = buffer->size + size;
+    if (needed < buffer->size) return SLOPE_ERROR;
+    if (needed > buffer->nalloc) {
+        size_t nalloc = buffer->nalloc*2;
+        if (nalloc < needed) nalloc = needed;
+        if (nalloc < SLOPE_BUFFER_MIN_ALLOC) nalloc = SLOPE_BUFFER_MIN_ALLOC;
+        if (__slope_buffer_realloc(buffer, nalloc) != SLOPE_SUCCESS) {
+            return SLOPE_ERROR;
+        }
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size = needed;
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_buffer_reserve (slope_buffer_t *buffer, size_t nalloc)
+{
+    if (buffer == NULL) return SLOPE_ERROR;
+    if (nalloc <= buffer->nalloc) return SLOPE_SUCCESS;
+    return __slope_buffer_realloc(buffer, nalloc);
+}
+
+
+void slope_buffer_clear (slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return;
+    buffer->size = 0;
+}
+
+
+unsigned char* slope_buffer_detach (slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return NULL;
+    unsigned char *data = buffer->data;
+    buffer->data = NULL;
+    buffer->nalloc = 0;
+    buffer->size = 0;
+    return data;
+}
+
+
+size_t slope_buffer_get_size (const slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return 0;
+    return buffer->size;
+}
+
+
+const unsigned char* slope_buffer_get_data (const slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return NULL;
+    return buffer->data;
+}
+
+/* slope/buffer.c */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_BUFFER_H
+#define SLOPE_BUFFER_H
+
+#include "slope/primitives.h"
+#include <stddef.h>
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * A growable block of bytes, used to encode figures in memory.
+ */
+typedef struct _slope_buffer
+{
+    unsigned char *data;
+    size_t nalloc;
+    size_t size;
+}
+slope_buffer_t;
+
+
+/**
+ * @brief Creates an empty buffer with room for size bytes.
+ * @return The buffer or NULL if out of memory.
+ */
+slope_public slope_buffer_t* slope_buffer_create (size_t size);
+
+/**
+ */
+slope_public void slope_buffer_destroy (slope_buffer_t *buffer);
+
+/**
+ * @brief Appends size bytes, growing the storage geometrically.
+ * @return SLOPE_SUCCESS or SLOPE_ERROR if out of memory.
+ */
+slope_public int slope_buffer_append (slope_buffer_t *buffer,
+                                      const void *data, size_t size);
+
+/**
+ * @brief Makes room for at least nalloc bytes.
+ * @return SLOPE_SUCCESS or SLOPE_ERROR if out of memory.
+ */
+slope_public int slope_buffer_reserve (slope_buffer_t *buffer, size_t nalloc);
+
+/**
+ * @brief Removes every byte, keeping the storage.
+ */
+slope_public void slope_buffer_clear (slope_buffer_t *buffer);
+
+/**
+ * @brief Hands the bytes over to the caller, who must free() them,
+ * and leaves the buffer empty.
+ */
+slope_public unsigned char* slope_buffer_detach (slope_buffer_t *buffer);
+
+/**
+ */
+slope_public size_t slope_buffer_get_size (const slope_buffer_t *buffer);
+
+/**
+ */
+slope_public const unsigned char*
+slope_buffer_get_data (const slope_buffer_t *buffer);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_BUFFER_H */
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/dataview_p.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+int __slope_dataview_size (slope_dtype_t type)
+{
+    switch (type) {
+        case SLOPE_FLOAT:
+            return sizeof(float);
+        case SLOPE_INT16:
+            return sizeof(int16_t);
+        default:
+            return sizeof(double);
+    }
+}
+
+
+void slope_dataview_init (slope_dataview_t *view, const void *data,
+                          slope_dtype_t type, int offset, int stride)
+{
+    if (view == NULL) return;
+    view->data = data;
+    view->type = type;
+    view->offset = offset;
+    view->stride = stride > 0 ? stride : __slope_dataview_size(type);
+    view->start = 0.0;
+    view->step = 1.0;
+}
+
+
+void slope_dataview_init_implicit (slope_dataview_t *view,
+                                   double start, double step)
+{
+    if (view == NULL) return;
+    view->data = NULL;
+    view->type = SLOPE_DOUBLE;
+    view->offset = 0;
+    view->stride = sizeof(double);
+    view->start = start;
+    view->step = step;
+}
+
+
+void __slope_dataview_fetch (const slope_dataview_t *view,
+                             int start, int count, double *out)
+{
+    int k;
+    if (view->data == NULL) {
+        for (k=0; k<count; k++) {
+            out[k] = view->start + (start + k)*view->step;
+        }
+        return;
+    }
+
+    const char *p = (const char*) view->data
+                    + view->offset + (size_t) start*view->stride;
+    const int packed = view->stride == __slope_dataview_size(view->type);
+
+    /* values are copied out of the bytes, the header of a mapped file
+       or the record layout may leave them at any address; compilers
+       turn these copies into plain loads, and packed values get their
+       own loops, which they vectorize */
+    switch (view->type) {
+        case SLOPE_DOUBLE:
+            for (k=0; k<count; k++, p+=view->stride) {
+                memcpy(&out[k], p, sizeof(double));
+            }
+            break;
+        case SLOPE_FLOAT:
+            if (packed) {
+                for (k=0; k<count; k++) {
+                    float value;
+                    memcpy(&value, p + k*sizeof(float), sizeof(float));
+                    out[k] = value;
+                }
+            }
+            else {
+                for (k=0; k<count; k++, p+=view->stride) {
+                    float value;
+                    memcpy(&value, p, sizeof(float));
+                    out[k] = value;
+                }
+            }
+            break;
+        case SLOPE_INT16:
+            if (packed) {
+                for (k=0; k<count; k++) {
+                    int16_t value;
+                    memcpy(&value, p + k*sizeof(int16_t), sizeof(int16_t));
+                    out[k] = value;
+                }
+            }
+            else {
+                for (k=0; k<count; k++, p+=view->stride) {
+                    int16_t value;
+                    memcpy(&value, p, sizeof(int16_t));
+                    out[k] = value;
+                }
+            }
+            break;
+    }
+}
+
+
+double __slope_dataview_at (const slope_dataview_t *view, int k)
+{
+    if (view->data == NULL) {
+        return view->start + k*view->step;
+    }
+    const char *p = (const char*) view->data
+                    + view->offset + (size_t) k*view->stride;
+    switch (view->type) {
+        case SLOPE_FLOAT: {
+            float value;
+            memcpy(&value, p, sizeof(float));
+            return value;
+        }
+        case SLOPE_INT16: {
+            int16_t value;
+            memcpy(&value, p, sizeof(int16_t));
+            return value;
+        }
+        default: {
+            double value;
+            memcpy(&value, p, sizeof(double));
+            return value;
+        }
+    }
+}
+
+
+const double* __slope_dataview_doubles (const slope_dataview_t *view)
+{
+    if (view->data == NULL || view->type != SLOPE_DOUBLE
+            || view->stride != sizeof(double)) {
+        return NULL;
+    }
+    const char *p = (const char*) view->data + view->offset;
+    if ((uintptr_t) p % sizeof(double) != 0) {
+        return NULL;
+    }
+    return (const double*) p;
+}
+
+/* slope/dataview.c */
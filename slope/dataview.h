@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_DATAVIEW_H
+#define SLOPE_DATAVIEW_H
+
+#include "slope/global.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ */
+typedef enum _slope_dtype
+{
+    SLOPE_DOUBLE = 0,
+    SLOPE_FLOAT  = 1,
+    SLOPE_INT16  = 2
+}
+slope_dtype_t;
+
+/**
+ * Describes where the values of a data series are, so items can plot
+ * float, int16 or interleaved records without converting them to
+ * arrays of doubles first. Value k is read from offset + k*stride
+ * bytes past data. If data is NULL the values are implicit and value
+ * k is start + k*step.
+ */
+typedef struct _slope_dataview
+{
+    const void    *data;
+    slope_dtype_t  type;
+    int            offset;
+    int            stride;
+    double         start, step;
+}
+slope_dataview_t;
+
+/**
+ * @brief Sets a view over values of the given type. A stride of 0
+ * means the values are packed.
+ */
+slope_public void
+slope_dataview_init (slope_dataview_t *view, const void *data,
+                     slope_dtype_t type, int offset, int stride);
+
+/**
+ * @brief Sets a view of the implicit values start + k*step, as for
+ * the x of regularly sampled signals.
+ */
+slope_public void
+slope_dataview_init_implicit (slope_dataview_t *view,
+                              double start, double step);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_DATAVIEW_H */
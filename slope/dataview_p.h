@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_DATAVIEW_P_H
+#define SLOPE_DATAVIEW_P_H
+
+#include "slope/dataview.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Size in bytes of a value of the given type.
+ */
+int __slope_dataview_size (slope_dtype_t type);
+
+/**
+ * Converts values [start, start+count) of the view to doubles.
+ */
+void __slope_dataview_fetch (const slope_dataview_t *view,
+                             int start, int count, double *out);
+
+/**
+ */
+double __slope_dataview_at (const slope_dataview_t *view, int k);
+
+/**
+ * The values as an array of doubles if that is how they are stored,
+ * suitably aligned, NULL otherwise.
+ */
+const double* __slope_dataview_doubles (const slope_dataview_t *view);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_DATAVIEW_P_H */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/document.h"
+#include "slope/export_p.h"
+#include <stdlib.h>
+#include <cairo.h>
+#include <cairo-pdf.h>
+#include <cairo-ps.h>
+
+
+/**
+ */
+struct _slope_document
+{
+    cairo_surface_t *surf;
+    slope_format_t format;
+    slope_export_stream_t stream;
+    int npages;
+};
+
+
+static slope_document_t* __slope_document_create (const char *filename,
+                                                  slope_format_t format,
+                                                  slope_write_func_t write_func,
+                                                  void *closure)
+{
+    if (format != SLOPE_FORMAT_PDF && format != SLOPE_FORMAT_PS) {
+        return NULL;
+    }
+    slope_document_t *document = malloc(sizeof(slope_document_t));
+    if (document == NULL) return NULL;
+    document->format = format;
+    document->stream.write_func = write_func;
+    document->stream.closure = closure;
+    document->npages = 0;
+
+    /* the size is set again for every page */
+    if (format == SLOPE_FORMAT_PDF) {
+        document->surf = filename
+            ? cairo_pdf_surface_create(filename, 1.0, 1.0)
+            : cairo_pdf_surface_create_for_stream(
+                  __slope_export_stream_write, &document->stream, 1.0, 1.0);
+    }
+    else {
+        document->surf = filename
+            ? cairo_ps_surface_create(filename, 1.0, 1.0)
+            : cairo_ps_surface_create_for_stream(
+                  __slope_export_stream_write, &document->stream, 1.0, 1.0);
+    }
+    if (cairo_surface_status(document->surf) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(document->surf);
+        free(document);
+        return NULL;
+    }
+    return document;
+}
+
+
+slope_document_t* slope_document_create (const char *filename,
+                                         slope_format_t format)
+{
+    if (filename == NULL) return NULL;
+    return __slope_document_create(filename, format, NULL, NULL);
+}
+
+
+slope_document_t*
+slope_document_create_for_stream (slope_format_t format,
+                                  slope_write_func_t write_func,
+                                  void *closure)
+{
+    if (write_func == NULL) return NULL;
+    return __slope_document_create(NULL, format, write_func, closure);
+}
+
+
+slope_document_t*
+slope_document_create_for_buffer (slope_format_t format,
+                                  slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return NULL;
+    return __slope_document_create(NULL, format,
+                                   __slope_export_buffer_write, buffer);
+}
+
+
+static cairo_t* __slope_document_begin_page (slope_document_t *document,
+                                             double width, double height)
+{
+    if (document->format == SLOPE_FORMAT_PDF) {
+        cairo_pdf_surface_set_size(document->surf, width, height);
+    }
+    else {
+        cairo_ps_surface_set_size(document->surf, width, height);
+    }
+    return cairo_create(document->surf);
+}
+
+
+static int __slope_document_end_page (slope_document_t *document,
+                                      cairo_t *cr)
+{
+    cairo_show_page(cr);
+    cairo_status_t status = cairo_status(cr);
+    cairo_destroy(cr);
+    document->npages += 1;
+    if (status != CAIRO_STATUS_SUCCESS
+        || cairo_surface_status(document->surf) != CAIRO_STATUS_SUCCESS) {
+        return SLOPE_ERROR;
+    }
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_document_add_figure (slope_document_t *document,
+                               slope_figure_t *figure,
+                               double width, double height)
+{
+    if (document == NULL || figure == NULL) return SLOPE_ERROR;
+    if (width <= 0.0 || height <= 0.0) return SLOPE_ERROR;
+
+    cairo_t *cr = __slope_document_begin_page(document, width, height);
+    slope_rect_t rect;
+    slope_rect_set(&rect, 0.0, 0.0, width, height);
+    slope_figure_draw(figure, cr, &rect);
+    return __slope_document_end_page(document, cr);
+}
+
+
+int slope_document_add_recording (slope_document_t *document,
+                                  slope_recording_t *recording,
+                                  double width, double height)
+{
+    if (document == NULL || recording == NULL) return SLOPE_ERROR;
+    if (width <= 0.0 || height <= 0.0) return SLOPE_ERROR;
+
+    cairo_t *cr = __slope_document_begin_page(document, width, height);
+    __slope_recording_paint(recording, cr, width, height);
+    return __slope_document_end_page(document, cr);
+}
+
+
+int slope_document_get_page_count (const slope_document_t *document)
+{
+    if (document == NULL) return 0;
+    return document->npages;
+}
+
+
+int slope_document_close (slope_document_t *document)
+{
+    if (document == NULL) return SLOPE_ERROR;
+    cairo_surface_finish(document->surf);
+    cairo_status_t status = cairo_surface_status(document->surf);
+    cairo_surface_destroy(document->surf);
+    free(document);
+    return status == CAIRO_STATUS_SUCCESS ? SLOPE_SUCCESS : SLOPE_ERROR;
+}
+
+/* slope/document.c */
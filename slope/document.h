@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_DOCUMENT_H
+#define SLOPE_DOCUMENT_H
+
+#include "slope/export.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * A multi-page PDF or PostScript file. Every page is written to
+ * the same surface, so fonts and other resources used by several
+ * pages are only embedded once.
+ */
+typedef struct _slope_document slope_document_t;
+
+
+/**
+ * @brief Starts a document in a file.
+ * @return The document, or NULL if format isn't SLOPE_FORMAT_PDF or
+ * SLOPE_FORMAT_PS, the file can't be created or out of memory.
+ */
+slope_public slope_document_t*
+slope_document_create (const char *filename, slope_format_t format);
+
+/**
+ * @brief Starts a document whose output is passed to write_func.
+ */
+slope_public slope_document_t*
+slope_document_create_for_stream (slope_format_t format,
+                                  slope_write_func_t write_func,
+                                  void *closure);
+
+/**
+ * @brief Starts a document whose output is appended to buffer.
+ */
+slope_public slope_document_t*
+slope_document_create_for_buffer (slope_format_t format,
+                                  slope_buffer_t *buffer);
+
+/**
+ * @brief Draws the figure on a new page of the given size, in points.
+ */
+slope_public int
+slope_document_add_figure (slope_document_t *document,
+                           slope_figure_t *figure,
+                           double width, double height);
+
+/**
+ * @brief Replays the recording on a new page of the given size,
+ * in points.
+ */
+slope_public int
+slope_document_add_recording (slope_document_t *document,
+                              slope_recording_t *recording,
+                              double width, double height);
+
+/**
+ */
+slope_public int
+slope_document_get_page_count (const slope_document_t *document);
+
+/**
+ * @brief Writes out the rest of the document and destroys it.
+ * @return SLOPE_SUCCESS if the whole document was written.
+ */
+slope_public int
+slope_document_close (slope_document_t *document);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_DOCUMENT_H */
@@ -0,0 +1,661 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/encode_p.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(SLOPE_HAVE_ZLIB)
+# include <zlib.h>
+#endif
+
+/* bytes staged before each call to the write callback */
+#define SLOPE_ENCODE_BUFSIZE 65536
+
+/* largest payload of an IDAT chunk and of a stored deflate block */
+#define SLOPE_PNG_IDAT_SIZE 65536
+#define SLOPE_PNG_BLOCK_SIZE 65535
+
+/* the most bytes Adler-32 sums can take before they overflow 32 bits */
+#define SLOPE_ADLER_NMAX 5552
+
+
+typedef struct _slope_encoder
+{
+    slope_export_stream_t *stream;
+    unsigned char *buf;
+    size_t len;
+    int status;
+}
+slope_encoder_t;
+
+
+typedef struct _slope_png_encoder
+{
+    slope_encoder_t *out;
+    uint32_t crc_table[256];
+    unsigned char *idat;
+    size_t idat_len;
+    /* zlib stream state when data is stored uncompressed */
+    unsigned char *block;
+    size_t block_len;
+    uint32_t adler_a, adler_b;
+}
+slope_png_encoder_t;
+
+
+static void __slope_encode_flush (slope_encoder_t *out)
+{
+    if (out->len > 0 && out->status == SLOPE_SUCCESS) {
+        out->status = (*out->stream->write_func)(
+            out->stream->closure, out->buf, (unsigned int) out->len);
+    }
+    out->len = 0;
+}
+
+
+static void __slope_encode_put (slope_encoder_t *out,
+                                const void *data, size_t len)
+{
+    const unsigned char *bytes = (const unsigned char*) data;
+    while (len > 0) {
+        size_t n = SLOPE_ENCODE_BUFSIZE - out->len;
+        if (n > len) n = len;
+        memcpy(out->buf + out->len, bytes, n);
+        out->len += n;
+        bytes += n;
+        len -= n;
+        if (out->len == SLOPE_ENCODE_BUFSIZE) {
+            __slope_encode_flush(out);
+        }
+    }
+}
+
+
+static void __slope_encode_be32 (unsigned char *dst, uint32_t value)
+{
+    dst[0] = (unsigned char) (value >> 24);
+    dst[1] = (unsigned char) (value >> 16);
+    dst[2] = (unsigned char) (value >> 8);
+    dst[3] = (unsigned char) value;
+}
+
+
+/* cairo keeps premultiplied native endian words, files want
+   straight r, g, b, a bytes */
+void __slope_encode_rgba_row (const unsigned char *src,
+                              unsigned char *dst, int width)
+{
+    const uint32_t *px = (const uint32_t*) src;
+    int k;
+    for (k=0; k<width; k++) {
+        uint32_t p = px[k];
+        uint32_t a = p >> 24;
+        uint32_t r = (p >> 16) & 0xff;
+        uint32_t g = (p >> 8) & 0xff;
+        uint32_t b = p & 0xff;
+        if (a != 0xff && a != 0) {
+            r = (r*255 + a/2) / a;
+            g = (g*255 + a/2) / a;
+            b = (b*255 + a/2) / a;
+        }
+        dst[0] = (unsigned char) r;
+        dst[1] = (unsigned char) g;
+        dst[2] = (unsigned char) b;
+        dst[3] = (unsigned char) a;
+        dst += 4;
+    }
+}
+
+
+/* ---------------------------------------------------------------- */
+/* PNG */
+
+
+static uint32_t __slope_png_crc (const slope_png_encoder_t *png, uint32_t crc,
+                                 const unsigned char *data, size_t len)
+{
+    size_t k;
+    for (k=0; k<len; k++) {
+        crc = png->crc_table[(crc ^ data[k]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+
+static void __slope_png_chunk (slope_png_encoder_t *png, const char *type,
+                               const unsigned char *data, size_t len)
+{
+    unsigned char head[8];
+    unsigned char tail[4];
+    __slope_encode_be32(head, (uint32_t) len);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = __slope_png_crc(png, 0xffffffffu, head + 4, 4);
+    crc = __slope_png_crc(png, crc, data, len) ^ 0xffffffffu;
+    __slope_encode_be32(tail, crc);
+    __slope_encode_put(png->out, head, 8);
+    __slope_encode_put(png->out, data, len);
+    __slope_encode_put(png->out, tail, 4);
+}
+
+
+/* appends to the zlib stream, which is split in IDAT chunks */
+static void __slope_png_idat_put (slope_png_encoder_t *png,
+                                  const unsigned char *data, size_t len)
+{
+    while (len > 0) {
+        size_t n = SLOPE_PNG_IDAT_SIZE - png->idat_len;
+        if (n > len) n = len;
+        memcpy(png->idat + png->idat_len, data, n);
+        png->idat_len += n;
+        data += n;
+        len -= n;
+        if (png->idat_len == SLOPE_PNG_IDAT_SIZE) {
+            __slope_png_chunk(png, "IDAT", png->idat, png->idat_len);
+            png->idat_len = 0;
+        }
+    }
+}
+
+
+static void __slope_png_store_block (slope_png_encoder_t *png, int last)
+{
+    unsigned char head[5];
+    head[0] = last ? 1 : 0;
+    head[1] = (unsigned char) (png->block_len & 0xff);
+    head[2] = (unsigned char) (png->block_len >> 8);
+    head[3] = (unsigned char) (~png->block_len & 0xff);
+    head[4] = (unsigned char) ((~png->block_len >> 8) & 0xff);
+    __slope_png_idat_put(png, head, 5);
+    __slope_png_idat_put(png, png->block, png->block_len);
+    png->block_len = 0;
+}
+
+
+/* level 0, deflate stored blocks need no compressor at all */
+static void __slope_png_store (slope_png_encoder_t *png,
+                               const unsigned char *data, size_t len)
+{
+    uint32_t a = png->adler_a, b = png->adler_b;
+    size_t k, done;
+    for (done=0; done<len; ) {
+        size_t stop = done + SLOPE_ADLER_NMAX;
+        if (stop > len) stop = len;
+        for (k=done; k<stop; k++) {
+            a += data[k];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        done = stop;
+    }
+    png->adler_a = a;
+    png->adler_b = b;
+
+    while (len > 0) {
+        size_t n = SLOPE_PNG_BLOCK_SIZE - png->block_len;
+        if (n > len) n = len;
+        memcpy(png->block + png->block_len, data, n);
+        png->block_len += n;
+        data += n;
+        len -= n;
+        if (png->block_len == SLOPE_PNG_BLOCK_SIZE) {
+            __slope_png_store_block(png, SLOPE_FALSE);
+        }
+    }
+}
+
+
+static int __slope_png_paeth (int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+
+/* writes the filter type byte followed by the filtered row */
+static void __slope_png_filter_row (int type, const unsigned char *cur,
+                                    const unsigned char *prev,
+                                    unsigned char *dst, int n)
+{
+    int k;
+    *dst++ = (unsigned char) type;
+    switch (type) {
+        case SLOPE_PNG_FILTER_SUB:
+            for (k=0; k<4; k++) dst[k] = cur[k];
+            for (k=4; k<n; k++) dst[k] = cur[k] - cur[k-4];
+            break;
+        case SLOPE_PNG_FILTER_UP:
+            for (k=0; k<n; k++) dst[k] = cur[k] - prev[k];
+            break;
+        case SLOPE_PNG_FILTER_AVERAGE:
+            for (k=0; k<4; k++) dst[k] = cur[k] - (prev[k] >> 1);
+            for (k=4; k<n; k++) dst[k] = cur[k] - ((cur[k-4] + prev[k]) >> 1);
+            break;
+        case SLOPE_PNG_FILTER_PAETH:
+            for (k=0; k<4; k++) dst[k] = cur[k] - prev[k];
+            for (k=4; k<n; k++) {
+                dst[k] = cur[k] - (unsigned char)
+                    __slope_png_paeth(cur[k-4], prev[k], prev[k-4]);
+            }
+            break;
+        default:
+            memcpy(dst, cur, n);
+            break;
+    }
+}
+
+
+static unsigned long __slope_png_cost (const unsigned char *row, int n)
+{
+    unsigned long cost = 0;
+    int k;
+    for (k=1; k<=n; k++) {
+        cost += row[k] < 128 ? row[k] : 256 - row[k];
+    }
+    return cost;
+}
+
+
+static int __slope_encode_png (const unsigned char *data,
+                               int width, int height, int stride,
+                               int level, slope_png_filter_t filter,
+                               slope_encoder_t *out)
+{
+    static const unsigned char signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    const int n = 4*width;
+    slope_png_encoder_t png;
+    unsigned char ihdr[13];
+    uint32_t c;
+    int k, y, status = SLOPE_SUCCESS;
+
+    for (k=0; k<256; k++) {
+        int bit;
+        c = (uint32_t) k;
+        for (bit=0; bit<8; bit++) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        png.crc_table[k] = c;
+    }
+    png.out = out;
+    png.idat = malloc(SLOPE_PNG_IDAT_SIZE);
+    png.idat_len = 0;
+    png.block = NULL;
+    png.block_len = 0;
+    png.adler_a = 1;
+    png.adler_b = 0;
+
+    /* current and previous row, then one filtered row per filter
+       type so the adaptive strategy can pick the cheapest */
+    const int nfiltered = filter == SLOPE_PNG_FILTER_ADAPTIVE ? 5 : 1;
+    unsigned char *rows = calloc(2*n + nfiltered*(n + 1), 1);
+    if (png.idat == NULL || rows == NULL) {
+        free(png.idat);
+        free(rows);
+        return SLOPE_ERROR;
+    }
+    unsigned char *cur = rows;
+    unsigned char *prev = rows + n;
+    unsigned char *filtered = rows + 2*n;
+
+#if defined(SLOPE_HAVE_ZLIB)
+    z_stream zs;
+    unsigned char *zbuf = NULL;
+    if (level > 0) {
+        memset(&zs, 0, sizeof(zs));
+        if (deflateInit2(&zs, level > 9 ? 9 : level, Z_DEFLATED, 15, 8,
+                         filter == SLOPE_PNG_FILTER_NONE
+                         ? Z_DEFAULT_STRATEGY : Z_FILTERED) != Z_OK) {
+            level = 0;
+        }
+        else if ((zbuf = malloc(SLOPE_PNG_IDAT_SIZE)) == NULL) {
+            deflateEnd(&zs);
+            free(png.idat);
+            free(rows);
+            return SLOPE_ERROR;
+        }
+    }
+#else
+    /* without zlib every level stores the data */
+    level = 0;
+#endif
+    if (level == 0) {
+        static const unsigned char zlib_head[2] = { 0x78, 0x01 };
+        png.block = malloc(SLOPE_PNG_BLOCK_SIZE);
+        if (png.block == NULL) {
+            free(png.idat);
+            free(rows);
+            return SLOPE_ERROR;
+        }
+        __slope_png_idat_put(&png, zlib_head, 2);
+    }
+
+    __slope_encode_put(out, signature, 8);
+    __slope_encode_be32(ihdr, (uint32_t) width);
+    __slope_encode_be32(ihdr + 4, (uint32_t) height);
+    ihdr[8] = 8;  /* bits per sample */
+    ihdr[9] = 6;  /* truecolour with alpha */
+    ihdr[10] = 0; /* deflate */
+    ihdr[11] = 0; /* adaptive filtering */
+    ihdr[12] = 0; /* no interlace */
+    __slope_png_chunk(&png, "IHDR", ihdr, 13);
+
+    for (y=0; y<height && out->status == SLOPE_SUCCESS; y++) {
+        unsigned char *row = filtered;
+        __slope_encode_rgba_row(data + (size_t) y*stride, cur, width);
+        if (filter == SLOPE_PNG_FILTER_ADAPTIVE) {
+            unsigned long best = 0;
+            int type;
+            for (type=SLOPE_PNG_FILTER_NONE; type<=SLOPE_PNG_FILTER_PAETH; type++) {
+                unsigned char *candidate = filtered + type*(n + 1);
+                __slope_png_filter_row(type, cur, prev, candidate, n);
+                unsigned long cost = __slope_png_cost(candidate, n);
+                if (type == SLOPE_PNG_FILTER_NONE || cost < best) {
+                    best = cost;
+                    row = candidate;
+                }
+            }
+        }
+        else {
+            __slope_png_filter_row(filter, cur, prev, row, n);
+        }
+
+#if defined(SLOPE_HAVE_ZLIB)
+        if (level > 0) {
+            zs.next_in = row;
+            zs.avail_in = (uInt) (n + 1);
+            while (zs.avail_in > 0) {
+                zs.next_out = zbuf;
+                zs.avail_out = SLOPE_PNG_IDAT_SIZE;
+                deflate(&zs, Z_NO_FLUSH);
+                __slope_png_idat_put(&png, zbuf,
+                                     SLOPE_PNG_IDAT_SIZE - zs.avail_out);
+            }
+        }
+        else
+#endif
+        {
+            __slope_png_store(&png, row, n + 1);
+        }
+
+        unsigned char *tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+#if defined(SLOPE_HAVE_ZLIB)
+    if (level > 0) {
+        int zstatus;
+        do {
+            zs.next_out = zbuf;
+            zs.avail_out = SLOPE_PNG_IDAT_SIZE;
+            zstatus = deflate(&zs, Z_FINISH);
+            __slope_png_idat_put(&png, zbuf,
+                                 SLOPE_PNG_IDAT_SIZE - zs.avail_out);
+        } while (zstatus == Z_OK);
+        if (zstatus != Z_STREAM_END) status = SLOPE_ERROR;
+        deflateEnd(&zs);
+        free(zbuf);
+    }
+    else
+#endif
+    {
+        unsigned char adler[4];
+        __slope_png_store_block(&png, SLOPE_TRUE);
+        __slope_encode_be32(adler, (png.adler_b << 16) | png.adler_a);
+        __slope_png_idat_put(&png, adler, 4);
+        free(png.block);
+    }
+    if (png.idat_len > 0) {
+        __slope_png_chunk(&png, "IDAT", png.idat, png.idat_len);
+    }
+    __slope_png_chunk(&png, "IEND", NULL, 0);
+
+    free(rows);
+    free(png.idat);
+    return status;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* Netpbm */
+
+
+static int __slope_encode_pnm (const unsigned char *data,
+                               int width, int height, int stride,
+                               int alpha, slope_encoder_t *out)
+{
+    char head[128];
+    int y, k;
+    unsigned char *row = malloc(4*width);
+    if (row == NULL) {
+        return SLOPE_ERROR;
+    }
+    if (alpha) {
+        sprintf(head, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\n"
+                      "TUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+    }
+    else {
+        sprintf(head, "P6\n%d %d\n255\n", width, height);
+    }
+    __slope_encode_put(out, head, strlen(head));
+
+    for (y=0; y<height && out->status == SLOPE_SUCCESS; y++) {
+        __slope_encode_rgba_row(data + (size_t) y*stride, row, width);
+        if (alpha == SLOPE_FALSE) {
+            /* squeeze out the alpha bytes in place */
+            for (k=0; k<width; k++) {
+                row[3*k] = row[4*k];
+                row[3*k + 1] = row[4*k + 1];
+                row[3*k + 2] = row[4*k + 2];
+            }
+        }
+        __slope_encode_put(out, row, (alpha ? 4 : 3)*width);
+    }
+    free(row);
+    return SLOPE_SUCCESS;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* QOI, see https://qoiformat.org */
+
+
+#define SLOPE_QOI_OP_INDEX 0x00
+#define SLOPE_QOI_OP_DIFF  0x40
+#define SLOPE_QOI_OP_LUMA  0x80
+#define SLOPE_QOI_OP_RUN   0xc0
+#define SLOPE_QOI_OP_RGB   0xfe
+#define SLOPE_QOI_OP_RGBA  0xff
+
+
+static int __slope_encode_qoi (const unsigned char *data,
+                               int width, int height, int stride,
+                               slope_encoder_t *out)
+{
+    static const unsigned char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    unsigned char head[14];
+    unsigned char index[64][4];
+    unsigned char prev[4] = { 0, 0, 0, 255 };
+    int run = 0;
+    int x, y;
+
+    /* a pixel takes 5 bytes at most */
+    unsigned char *row = malloc(4*width);
+    unsigned char *ops = malloc(5*width + 1);
+    if (row == NULL || ops == NULL) {
+        free(ops);
+        free(row);
+        return SLOPE_ERROR;
+    }
+
+    memcpy(head, "qoif", 4);
+    __slope_encode_be32(head + 4, (uint32_t) width);
+    __slope_encode_be32(head + 8, (uint32_t) height);
+    head[12] = 4; /* channels */
+    head[13] = 0; /* sRGB with linear alpha */
+    __slope_encode_put(out, head, 14);
+    memset(index, 0, sizeof(index));
+
+    for (y=0; y<height && out->status == SLOPE_SUCCESS; y++) {
+        unsigned char *op = ops;
+        __slope_encode_rgba_row(data + (size_t) y*stride, row, width);
+        for (x=0; x<width; x++) {
+            const unsigned char *px = row + 4*x;
+            if (memcmp(px, prev, 4) == 0) {
+                if (++run == 62) {
+                    *op++ = SLOPE_QOI_OP_RUN | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *op++ = SLOPE_QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+            int hash = (px[0]*3 + px[1]*5 + px[2]*7 + px[3]*11) % 64;
+            if (memcmp(index[hash], px, 4) == 0) {
+                *op++ = SLOPE_QOI_OP_INDEX | hash;
+            }
+            else if (px[3] == prev[3]) {
+                signed char dr = (signed char) (px[0] - prev[0]);
+                signed char dg = (signed char) (px[1] - prev[1]);
+                signed char db = (signed char) (px[2] - prev[2]);
+                signed char dr_dg = (signed char) (dr - dg);
+                signed char db_dg = (signed char) (db - dg);
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1
+                    && db >= -2 && db <= 1) {
+                    *op++ = SLOPE_QOI_OP_DIFF
+                        | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                }
+                else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7
+                         && db_dg >= -8 && db_dg <= 7) {
+                    *op++ = SLOPE_QOI_OP_LUMA | (dg + 32);
+                    *op++ = (unsigned char) ((dr_dg + 8) << 4 | (db_dg + 8));
+                }
+                else {
+                    *op++ = SLOPE_QOI_OP_RGB;
+                    *op++ = px[0];
+                    *op++ = px[1];
+                    *op++ = px[2];
+                }
+            }
+            else {
+                *op++ = SLOPE_QOI_OP_RGBA;
+                memcpy(op, px, 4);
+                op += 4;
+            }
+            memcpy(index[hash], px, 4);
+            memcpy(prev, px, 4);
+        }
+        __slope_encode_put(out, ops, op - ops);
+    }
+    if (run > 0) {
+        unsigned char op = SLOPE_QOI_OP_RUN | (run - 1);
+        __slope_encode_put(out, &op, 1);
+    }
+    __slope_encode_put(out, padding, 8);
+    free(ops);
+    free(row);
+    return SLOPE_SUCCESS;
+}
+
+
+/* ---------------------------------------------------------------- */
+
+
+int __slope_encode_is_native (slope_format_t format,
+                              const slope_export_options_t *options)
+{
+    switch (format) {
+        case SLOPE_FORMAT_PNG:
+            return options != NULL && options->png_level >= 0;
+        case SLOPE_FORMAT_PPM:
+        case SLOPE_FORMAT_PAM:
+        case SLOPE_FORMAT_QOI:
+            return SLOPE_TRUE;
+        default:
+            return SLOPE_FALSE;
+    }
+}
+
+
+int __slope_encode_image (const unsigned char *data,
+                          int width, int height, int stride,
+                          slope_format_t format,
+                          const slope_export_options_t *options,
+                          slope_export_stream_t *stream)
+{
+    slope_export_options_t defaults;
+    slope_encoder_t out;
+    int status;
+
+    if (data == NULL || width < 1 || height < 1 || stride < 4*width) {
+        return SLOPE_ERROR;
+    }
+    if (options == NULL) {
+        slope_export_options_init(&defaults);
+        options = &defaults;
+    }
+    out.stream = stream;
+    out.buf = malloc(SLOPE_ENCODE_BUFSIZE);
+    if (out.buf == NULL) {
+        return SLOPE_ERROR;
+    }
+    out.len = 0;
+    out.status = SLOPE_SUCCESS;
+
+    switch (format) {
+        case SLOPE_FORMAT_PNG:
+            status = __slope_encode_png(
+                data, width, height, stride,
+                options->png_level < 0 ? 6 : options->png_level,
+                options->png_filter, &out);
+            break;
+        case SLOPE_FORMAT_PPM:
+            status = __slope_encode_pnm(data, width, height, stride,
+                                        SLOPE_FALSE, &out);
+            break;
+        case SLOPE_FORMAT_PAM:
+            status = __slope_encode_pnm(data, width, height, stride,
+                                        SLOPE_TRUE, &out);
+            break;
+        case SLOPE_FORMAT_QOI:
+            status = __slope_encode_qoi(data, width, height, stride, &out);
+            break;
+        default:
+            status = SLOPE_ERROR;
+            break;
+    }
+    __slope_encode_flush(&out);
+    free(out.buf);
+    if (out.status != SLOPE_SUCCESS) status = SLOPE_ERROR;
+    return status;
+}
+
+/* slope/encode.c */
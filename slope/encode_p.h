@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_ENCODE_P_H
+#define SLOPE_ENCODE_P_H
+
+#include "slope/export_p.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Tells if the format and options are handled by the encoders below
+ * rather than by cairo.
+ */
+int __slope_encode_is_native (slope_format_t format,
+                              const slope_export_options_t *options);
+
+/**
+ * Converts a row of ARGB32 pixels to straight alpha r, g, b, a bytes.
+ */
+void __slope_encode_rgba_row (const unsigned char *src,
+                              unsigned char *dst, int width);
+
+/**
+ * Encodes ARGB32 pixels, as laid out by cairo image surfaces, in a
+ * raster format. Rows are converted one at a time while they are
+ * written out, the image is never copied as a whole.
+ */
+int __slope_encode_image (const unsigned char *data,
+                          int width, int height, int stride,
+                          slope_format_t format,
+                          const slope_export_options_t *options,
+                          slope_export_stream_t *stream);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_ENCODE_P_H */
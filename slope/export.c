@@ -0,0 +1,568 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/export_p.h"
+#include "slope/encode_p.h"
+#include "slope/figure_p.h"
+#include "slope/parallel_p.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <cairo.h>
+#include <cairo-svg.h>
+#include <cairo-pdf.h>
+#include <cairo-ps.h>
+
+
+/**
+ * Jobs sorted so the ones of each figure are contiguous. Each group
+ * of jobs sharing a figure is a single task of the pool.
+ */
+typedef struct _slope_export_batch
+{
+    slope_export_job_t *jobs;
+    int *order;
+    int *group;
+    int ngroups;
+}
+slope_export_batch_t;
+
+
+/**
+ * Where encoded output goes, a file if filename is set, otherwise
+ * the stream, and how raster formats are encoded. The time spent
+ * encoding is reported back in encode_time.
+ */
+typedef struct _slope_export_target
+{
+    const char *filename;
+    slope_export_stream_t stream;
+    const slope_export_options_t *options;
+    double encode_time;
+}
+slope_export_target_t;
+
+
+/**
+ * Draws a source over a whole output surface of the given size.
+ */
+typedef void (*slope_export_draw_t) (void *source, cairo_surface_t *surf,
+                                     int width, int height);
+
+
+/**
+ */
+typedef struct _slope_export_figure
+{
+    slope_figure_t *figure;
+    int nthreads;
+}
+slope_export_figure_t;
+
+
+cairo_status_t __slope_export_stream_write (void *closure,
+                                            const unsigned char *data,
+                                            unsigned int length)
+{
+    slope_export_stream_t *stream = (slope_export_stream_t*) closure;
+    if ((*stream->write_func)(stream->closure, data, length) != SLOPE_SUCCESS) {
+        return CAIRO_STATUS_WRITE_ERROR;
+    }
+    return CAIRO_STATUS_SUCCESS;
+}
+
+
+static cairo_surface_t*
+__slope_export_create_surface (slope_export_target_t *target,
+                               slope_format_t format,
+                               int width, int height)
+{
+    const char *filename = target->filename;
+    cairo_write_func_t write_func = __slope_export_stream_write;
+    void *closure = &target->stream;
+
+    switch (format) {
+        case SLOPE_FORMAT_PNG:
+        case SLOPE_FORMAT_PPM:
+        case SLOPE_FORMAT_PAM:
+        case SLOPE_FORMAT_QOI:
+            return cairo_image_surface_create(
+                CAIRO_FORMAT_ARGB32, width, height);
+        case SLOPE_FORMAT_SVG:
+            return filename
+                ? cairo_svg_surface_create(filename, width, height)
+                : cairo_svg_surface_create_for_stream(
+                      write_func, closure, width, height);
+        case SLOPE_FORMAT_PDF:
+            return filename
+                ? cairo_pdf_surface_create(filename, width, height)
+                : cairo_pdf_surface_create_for_stream(
+                      write_func, closure, width, height);
+        case SLOPE_FORMAT_PS:
+            return filename
+                ? cairo_ps_surface_create(filename, width, height)
+                : cairo_ps_surface_create_for_stream(
+                      write_func, closure, width, height);
+    }
+    return NULL;
+}
+
+
+static int __slope_export_file_write (void *closure,
+                                      const unsigned char *data,
+                                      unsigned int length)
+{
+    FILE *file = (FILE*) closure;
+    return fwrite(data, 1, length, file) == length
+        ? SLOPE_SUCCESS : SLOPE_ERROR;
+}
+
+
+static int __slope_export_encode_image (slope_export_target_t *target,
+                                        slope_format_t format,
+                                        cairo_surface_t *surf)
+{
+    const unsigned char *data = cairo_image_surface_get_data(surf);
+    int width = cairo_image_surface_get_width(surf);
+    int height = cairo_image_surface_get_height(surf);
+    int stride = cairo_image_surface_get_stride(surf);
+
+    if (target->filename == NULL) {
+        return __slope_encode_image(data, width, height, stride, format,
+                                    target->options, &target->stream);
+    }
+    slope_export_stream_t stream;
+    FILE *file = fopen(target->filename, "wb");
+    if (file == NULL) return SLOPE_ERROR;
+    stream.write_func = __slope_export_file_write;
+    stream.closure = file;
+    int status = __slope_encode_image(data, width, height, stride, format,
+                                      target->options, &stream);
+    if (fclose(file) != 0) status = SLOPE_ERROR;
+    return status;
+}
+
+
+static int __slope_export_encode (slope_export_target_t *target,
+                                  slope_format_t format,
+                                  int width, int height,
+                                  slope_export_draw_t draw, void *source)
+{
+    if (width < 1 || height < 1) return SLOPE_ERROR;
+    cairo_surface_t *surf = __slope_export_create_surface(
+        target, format, width, height);
+    if (surf == NULL) return SLOPE_ERROR;
+
+    cairo_status_t status = cairo_surface_status(surf);
+    if (status == CAIRO_STATUS_SUCCESS) {
+        (*draw)(source, surf, width, height);
+        double start = __slope_figure_stats_clock();
+        if (__slope_encode_is_native(format, target->options)) {
+            cairo_surface_flush(surf);
+            status = __slope_export_encode_image(target, format, surf)
+                == SLOPE_SUCCESS ? CAIRO_STATUS_SUCCESS
+                                 : CAIRO_STATUS_WRITE_ERROR;
+        }
+        else if (format == SLOPE_FORMAT_PNG) {
+            status = target->filename
+                ? cairo_surface_write_to_png(surf, target->filename)
+                : cairo_surface_write_to_png_stream(
+                      surf, __slope_export_stream_write, &target->stream);
+        }
+        else {
+            /* vector surfaces only write everything out when finished */
+            cairo_surface_finish(surf);
+            status = cairo_surface_status(surf);
+        }
+        target->encode_time = __slope_figure_stats_clock() - start;
+    }
+    cairo_surface_destroy(surf);
+    return status == CAIRO_STATUS_SUCCESS ? SLOPE_SUCCESS : SLOPE_ERROR;
+}
+
+
+static void __slope_export_draw_figure (void *source, cairo_surface_t *surf,
+                                        int width, int height)
+{
+    slope_export_figure_t *self = (slope_export_figure_t*) source;
+    if (cairo_surface_get_type(surf) == CAIRO_SURFACE_TYPE_IMAGE) {
+        __slope_figure_draw_image(self->figure, surf, self->nthreads);
+        return;
+    }
+    cairo_t *cr = cairo_create(surf);
+    slope_rect_t rect;
+    slope_rect_set(&rect, 0.0, 0.0, width, height);
+    slope_figure_draw(self->figure, cr, &rect);
+    cairo_destroy(cr);
+}
+
+
+static void __slope_export_draw_recording (void *source,
+                                           cairo_surface_t *surf,
+                                           int width, int height)
+{
+    cairo_t *cr = cairo_create(surf);
+    __slope_recording_paint((slope_recording_t*) source, cr, width, height);
+    cairo_destroy(cr);
+}
+
+
+void __slope_recording_paint (const slope_recording_t *recording,
+                              cairo_t *cr, double width, double height)
+{
+    cairo_save(cr);
+    if (width != recording->width || height != recording->height) {
+        cairo_scale(cr, width / recording->width,
+                    height / recording->height);
+    }
+    cairo_set_source_surface(cr, recording->surf, 0.0, 0.0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+
+/**
+ * Encodes a figure, its render statistics covering the encoding too.
+ */
+static int __slope_export_figure (slope_export_target_t *target,
+                                  slope_figure_t *figure,
+                                  slope_format_t format,
+                                  int width, int height, int nthreads)
+{
+    slope_export_figure_t source;
+    source.figure = figure;
+    source.nthreads = nthreads;
+    target->encode_time = 0.0;
+    __slope_figure_stats_hold(figure);
+    int status = __slope_export_encode(target, format, width, height,
+                                       __slope_export_draw_figure, &source);
+    if (figure->stats_enabled) {
+        figure->stats.encode_time = target->encode_time;
+    }
+    __slope_figure_stats_release(figure);
+    return status;
+}
+
+
+static int __slope_export_write (slope_figure_t *figure,
+                                 const char *filename,
+                                 slope_format_t format,
+                                 int width, int height,
+                                 const slope_export_options_t *options,
+                                 int nthreads)
+{
+    if (figure == NULL || filename == NULL) return SLOPE_ERROR;
+    slope_export_target_t target;
+    target.filename = filename;
+    target.options = options;
+    return __slope_export_figure(&target, figure, format, width, height,
+                                 nthreads);
+}
+
+
+void slope_export_options_init (slope_export_options_t *options)
+{
+    if (options == NULL) return;
+    options->png_level = -1;
+    options->png_filter = SLOPE_PNG_FILTER_ADAPTIVE;
+}
+
+
+int slope_figure_write_to_file (slope_figure_t *figure,
+                                const char *filename,
+                                slope_format_t format,
+                                int width, int height)
+{
+    return __slope_export_write(figure, filename, format, width, height,
+                                NULL, __slope_parallel_ncpu());
+}
+
+
+int slope_figure_encode_to_file (slope_figure_t *figure,
+                                 const char *filename,
+                                 slope_format_t format,
+                                 int width, int height,
+                                 const slope_export_options_t *options)
+{
+    return __slope_export_write(figure, filename, format, width, height,
+                                options, __slope_parallel_ncpu());
+}
+
+
+int slope_figure_render_to_buffer (slope_figure_t *figure,
+                                   unsigned char *data,
+                                   int width, int height, int stride)
+{
+    if (figure == NULL || data == NULL) return SLOPE_ERROR;
+    if (width < 1 || height < 1) return SLOPE_ERROR;
+    int min_stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+    if (stride == 0) stride = min_stride;
+    /* cairo needs rows aligned as it would have made them */
+    if (stride < min_stride || stride % 4 != 0) return SLOPE_ERROR;
+
+    /* a figure without background leaves transparent pixels */
+    memset(data, 0, (size_t) stride*height);
+    cairo_surface_t *surf = cairo_image_surface_create_for_data(
+        data, CAIRO_FORMAT_ARGB32, width, height, stride);
+    if (cairo_surface_status(surf) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surf);
+        return SLOPE_ERROR;
+    }
+    __slope_figure_draw_image(figure, surf, __slope_parallel_ncpu());
+    cairo_surface_flush(surf);
+    cairo_surface_destroy(surf);
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_figure_write_to_stream (slope_figure_t *figure,
+                                  slope_format_t format,
+                                  int width, int height,
+                                  slope_write_func_t write_func,
+                                  void *closure)
+{
+    return slope_figure_encode_to_stream(figure, format, width, height,
+                                         NULL, write_func, closure);
+}
+
+
+int slope_figure_encode_to_stream (slope_figure_t *figure,
+                                   slope_format_t format,
+                                   int width, int height,
+                                   const slope_export_options_t *options,
+                                   slope_write_func_t write_func,
+                                   void *closure)
+{
+    if (figure == NULL || write_func == NULL) return SLOPE_ERROR;
+    slope_export_target_t target;
+    target.filename = NULL;
+    target.options = options;
+    target.stream.write_func = write_func;
+    target.stream.closure = closure;
+    return __slope_export_figure(&target, figure, format, width, height,
+                                 __slope_parallel_ncpu());
+}
+
+
+int slope_image_encode (const unsigned char *data,
+                        int width, int height, int stride,
+                        slope_format_t format,
+                        const slope_export_options_t *options,
+                        slope_write_func_t write_func,
+                        void *closure)
+{
+    slope_export_options_t png_options;
+    slope_export_stream_t stream;
+    if (write_func == NULL) return SLOPE_ERROR;
+    if (format == SLOPE_FORMAT_PNG
+        && (options == NULL || options->png_level < 0)) {
+        slope_export_options_init(&png_options);
+        if (options) png_options.png_filter = options->png_filter;
+        png_options.png_level = 6;
+        options = &png_options;
+    }
+    if (__slope_encode_is_native(format, options) == SLOPE_FALSE) {
+        return SLOPE_ERROR;
+    }
+    stream.write_func = write_func;
+    stream.closure = closure;
+    return __slope_encode_image(data, width, height, stride, format,
+                                options, &stream);
+}
+
+
+int __slope_export_buffer_write (void *closure,
+                                 const unsigned char *data,
+                                 unsigned int length)
+{
+    return slope_buffer_append((slope_buffer_t*) closure, data, length);
+}
+
+
+int slope_figure_write_to_buffer (slope_figure_t *figure,
+                                  slope_format_t format,
+                                  int width, int height,
+                                  slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return SLOPE_ERROR;
+    return slope_figure_write_to_stream(figure, format, width, height,
+                                        __slope_export_buffer_write, buffer);
+}
+
+
+slope_recording_t* slope_figure_record (slope_figure_t *figure,
+                                        int width, int height)
+{
+    if (figure == NULL || width < 1 || height < 1) return NULL;
+    cairo_rectangle_t extents;
+    extents.x = 0.0;
+    extents.y = 0.0;
+    extents.width = width;
+    extents.height = height;
+    cairo_surface_t *surf = cairo_recording_surface_create(
+        CAIRO_CONTENT_COLOR_ALPHA, &extents);
+    if (cairo_surface_status(surf) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surf);
+        return NULL;
+    }
+
+    cairo_t *cr = cairo_create(surf);
+    slope_rect_t rect;
+    slope_rect_set(&rect, 0.0, 0.0, width, height);
+    slope_figure_draw(figure, cr, &rect);
+    cairo_destroy(cr);
+
+    slope_recording_t *recording = malloc(sizeof(slope_recording_t));
+    if (recording == NULL) {
+        cairo_surface_destroy(surf);
+        return NULL;
+    }
+    recording->surf = surf;
+    recording->width = width;
+    recording->height = height;
+    return recording;
+}
+
+
+void slope_recording_destroy (slope_recording_t *recording)
+{
+    if (recording == NULL) return;
+    cairo_surface_destroy(recording->surf);
+    free(recording);
+}
+
+
+int slope_recording_write_to_file (slope_recording_t *recording,
+                                   const char *filename,
+                                   slope_format_t format,
+                                   int width, int height)
+{
+    if (recording == NULL || filename == NULL) return SLOPE_ERROR;
+    slope_export_target_t target;
+    target.filename = filename;
+    target.options = NULL;
+    return __slope_export_encode(&target, format, width, height,
+                                 __slope_export_draw_recording, recording);
+}
+
+
+int slope_recording_write_to_stream (slope_recording_t *recording,
+                                     slope_format_t format,
+                                     int width, int height,
+                                     slope_write_func_t write_func,
+                                     void *closure)
+{
+    if (recording == NULL || write_func == NULL) return SLOPE_ERROR;
+    slope_export_target_t target;
+    target.filename = NULL;
+    target.stream.write_func = write_func;
+    target.stream.closure = closure;
+    target.options = NULL;
+    return __slope_export_encode(&target, format, width, height,
+                                 __slope_export_draw_recording, recording);
+}
+
+
+int slope_recording_write_to_buffer (slope_recording_t *recording,
+                                     slope_format_t format,
+                                     int width, int height,
+                                     slope_buffer_t *buffer)
+{
+    if (buffer == NULL) return SLOPE_ERROR;
+    return slope_recording_write_to_stream(recording, format, width, height,
+                                           __slope_export_buffer_write,
+                                           buffer);
+}
+
+
+static int __slope_export_compare (const void *a, const void *b)
+{
+    const slope_export_job_t *ja = *(const slope_export_job_t* const*) a;
+    const slope_export_job_t *jb = *(const slope_export_job_t* const*) b;
+    uintptr_t fa = (uintptr_t) ja->figure;
+    uintptr_t fb = (uintptr_t) jb->figure;
+    if (fa != fb) return fa < fb ? -1 : 1;
+    /* keep the caller's order within a figure */
+    return ja < jb ? -1 : (ja > jb ? 1 : 0);
+}
+
+
+static void __slope_export_task (void *data, int index)
+{
+    slope_export_batch_t *batch = (slope_export_batch_t*) data;
+    int k;
+    for (k=batch->group[index]; k<batch->group[index+1]; k++) {
+        slope_export_job_t *job = &batch->jobs[batch->order[k]];
+        /* the pool already keeps every thread busy */
+        job->status = __slope_export_write(job->figure, job->filename,
+                                           job->format, job->width,
+                                           job->height, job->options, 1);
+    }
+}
+
+
+int slope_export_batch (slope_export_job_t *jobs, int njobs, int nthreads)
+{
+    if (jobs == NULL || njobs < 1) return SLOPE_SUCCESS;
+    if (nthreads < 1) nthreads = __slope_parallel_ncpu();
+
+    slope_export_batch_t batch;
+    slope_export_job_t **sorted = malloc(njobs*sizeof(slope_export_job_t*));
+    batch.jobs = jobs;
+    batch.order = malloc(njobs*sizeof(int));
+    batch.group = malloc((njobs + 1)*sizeof(int));
+    batch.ngroups = 0;
+    int k;
+
+    if (sorted == NULL || batch.order == NULL || batch.group == NULL) {
+        free(batch.group);
+        free(batch.order);
+        free(sorted);
+        for (k=0; k<njobs; k++) {
+            jobs[k].status = SLOPE_ERROR;
+        }
+        return SLOPE_ERROR;
+    }
+    for (k=0; k<njobs; k++) {
+        sorted[k] = &jobs[k];
+    }
+    qsort(sorted, njobs, sizeof(slope_export_job_t*), __slope_export_compare);
+    for (k=0; k<njobs; k++) {
+        batch.order[k] = (int) (sorted[k] - jobs);
+        if (k == 0 || sorted[k]->figure != sorted[k-1]->figure) {
+            batch.group[batch.ngroups++] = k;
+        }
+    }
+    batch.group[batch.ngroups] = njobs;
+
+    __slope_parallel_queue(__slope_export_task, &batch,
+                           batch.ngroups, nthreads);
+
+    int status = SLOPE_SUCCESS;
+    for (k=0; k<njobs; k++) {
+        if (jobs[k].status != SLOPE_SUCCESS) status = SLOPE_ERROR;
+    }
+    free(batch.group);
+    free(batch.order);
+    free(sorted);
+    return status;
+}
+
+/* slope/export.c */
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_EXPORT_H
+#define SLOPE_EXPORT_H
+
+#include "slope/figure.h"
+#include "slope/buffer.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ */
+typedef enum _slope_format
+{
+    SLOPE_FORMAT_PNG = 0,
+    SLOPE_FORMAT_SVG = 1,
+    SLOPE_FORMAT_PDF = 2,
+    SLOPE_FORMAT_PS  = 3,
+    SLOPE_FORMAT_PPM = 4, /* binary netpbm, alpha is dropped */
+    SLOPE_FORMAT_PAM = 5, /* netpbm RGB_ALPHA */
+    SLOPE_FORMAT_QOI = 6  /* the "Quite OK Image" format */
+}
+slope_format_t;
+
+/**
+ * PNG row filters. Adaptive tries every filter on each row and keeps
+ * the one likely to compress best, the others are faster.
+ */
+typedef enum _slope_png_filter
+{
+    SLOPE_PNG_FILTER_NONE     = 0,
+    SLOPE_PNG_FILTER_SUB      = 1,
+    SLOPE_PNG_FILTER_UP       = 2,
+    SLOPE_PNG_FILTER_AVERAGE  = 3,
+    SLOPE_PNG_FILTER_PAETH    = 4,
+    SLOPE_PNG_FILTER_ADAPTIVE = 5
+}
+slope_png_filter_t;
+
+/**
+ * Encoder settings for raster output.
+ */
+typedef struct _slope_export_options
+{
+    /* -1 lets cairo write the PNG, 0 stores it uncompressed, 1 to 9
+       are zlib levels (stored as well if slope was built without
+       zlib) */
+    int                png_level;
+    slope_png_filter_t png_filter;
+}
+slope_export_options_t;
+
+/**
+ * One file to be written by slope_export_batch. The status is set
+ * when the batch returns.
+ */
+typedef struct _slope_export_job
+{
+    slope_figure_t *figure;
+    const char     *filename;
+    slope_format_t  format;
+    int             width;
+    int             height;
+    int             status;
+    /* NULL for the defaults */
+    const slope_export_options_t *options;
+}
+slope_export_job_t;
+
+/**
+ * A figure drawn once, that can be written to any number of files
+ * without laying the figure out again.
+ */
+typedef struct _slope_recording slope_recording_t;
+
+/**
+ * Receives the encoded output of a figure in pieces.
+ * @return SLOPE_SUCCESS, or SLOPE_ERROR to abort the export.
+ */
+typedef int (*slope_write_func_t) (void *closure,
+                                   const unsigned char *data,
+                                   unsigned int length);
+
+
+/**
+ * @brief Sets the default options, PNG written by cairo.
+ */
+slope_public void
+slope_export_options_init (slope_export_options_t *options);
+
+/**
+ * @brief Writes the figure to a file of the given format.
+ */
+slope_public int
+slope_figure_write_to_file (slope_figure_t *figure,
+                            const char *filename,
+                            slope_format_t format,
+                            int width, int height);
+
+/**
+ * @brief Writes the figure to a file with the given encoder options,
+ * options may be NULL.
+ */
+slope_public int
+slope_figure_encode_to_file (slope_figure_t *figure,
+                             const char *filename,
+                             slope_format_t format,
+                             int width, int height,
+                             const slope_export_options_t *options);
+
+/**
+ * @brief Encodes the figure through write_func with the given
+ * encoder options, options may be NULL.
+ */
+slope_public int
+slope_figure_encode_to_stream (slope_figure_t *figure,
+                               slope_format_t format,
+                               int width, int height,
+                               const slope_export_options_t *options,
+                               slope_write_func_t write_func,
+                               void *closure);
+
+/**
+ * @brief Encodes ARGB32 pixels, as produced by
+ * slope_figure_render_to_buffer, in a raster format.
+ *
+ * Only PNG, PPM, PAM and QOI are accepted. PNG is always written by
+ * slope's own encoder here, a negative png_level means level 6.
+ */
+slope_public int
+slope_image_encode (const unsigned char *data,
+                    int width, int height, int stride,
+                    slope_format_t format,
+                    const slope_export_options_t *options,
+                    slope_write_func_t write_func,
+                    void *closure);
+
+/**
+ * @brief Draws the figure into caller owned ARGB32 pixels.
+ *
+ * The pixels are premultiplied, in native endian 32-bit words, as
+ * used by cairo. Rows are stride bytes apart, a stride of 0 packs
+ * them. The whole buffer is overwritten.
+ */
+slope_public int
+slope_figure_render_to_buffer (slope_figure_t *figure,
+                               unsigned char *data,
+                               int width, int height, int stride);
+
+/**
+ * @brief Encodes the figure in the given format and passes the
+ * output to write_func as it is produced.
+ */
+slope_public int
+slope_figure_write_to_stream (slope_figure_t *figure,
+                              slope_format_t format,
+                              int width, int height,
+                              slope_write_func_t write_func,
+                              void *closure);
+
+/**
+ * @brief Encodes the figure in the given format and appends the
+ * output to buffer.
+ */
+slope_public int
+slope_figure_write_to_buffer (slope_figure_t *figure,
+                              slope_format_t format,
+                              int width, int height,
+                              slope_buffer_t *buffer);
+
+/**
+ * @brief Records the figure's drawing at the given size.
+ *
+ * The recording keeps no reference to the figure, which can be
+ * changed or destroyed afterwards. Line series are recorded without
+ * decimation, so replaying at a larger size loses no detail.
+ */
+slope_public slope_recording_t*
+slope_figure_record (slope_figure_t *figure, int width, int height);
+
+/**
+ */
+slope_public void
+slope_recording_destroy (slope_recording_t *recording);
+
+/**
+ * @brief Replays the recording into a file of the given format.
+ *
+ * A size other than the recorded one scales the whole drawing,
+ * text and line widths included.
+ */
+slope_public int
+slope_recording_write_to_file (slope_recording_t *recording,
+                               const char *filename,
+                               slope_format_t format,
+                               int width, int height);
+
+/**
+ * @brief Replays the recording through write_func.
+ */
+slope_public int
+slope_recording_write_to_stream (slope_recording_t *recording,
+                                 slope_format_t format,
+                                 int width, int height,
+                                 slope_write_func_t write_func,
+                                 void *closure);
+
+/**
+ * @brief Replays the recording, appending the output to buffer.
+ */
+slope_public int
+slope_recording_write_to_buffer (slope_recording_t *recording,
+                                 slope_format_t format,
+                                 int width, int height,
+                                 slope_buffer_t *buffer);
+
+/**
+ * @brief Runs the jobs on a pool of nthreads threads, or one per
+ * processor if nthreads is 0.
+ *
+ * Different figures render concurrently, jobs sharing a figure run
+ * one after the other on the same thread. The figures must not be
+ * changed while the batch runs.
+ *
+ * @return SLOPE_SUCCESS if every job succeeded, SLOPE_ERROR otherwise.
+ */
+slope_public int
+slope_export_batch (slope_export_job_t *jobs, int njobs, int nthreads);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_EXPORT_H */
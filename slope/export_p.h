@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_EXPORT_P_H
+#define SLOPE_EXPORT_P_H
+
+#include "slope/export.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Adapts a slope_write_func_t to cairo's write callbacks.
+ */
+typedef struct _slope_export_stream
+{
+    slope_write_func_t write_func;
+    void *closure;
+}
+slope_export_stream_t;
+
+/**
+ */
+struct _slope_recording
+{
+    cairo_surface_t *surf;
+    int width;
+    int height;
+};
+
+/**
+ * Paints the recording scaled to width x height user units.
+ */
+void __slope_recording_paint (const slope_recording_t *recording,
+                              cairo_t *cr, double width, double height);
+
+/**
+ * A cairo_write_func_t forwarding to the slope_export_stream_t
+ * passed as closure.
+ */
+cairo_status_t __slope_export_stream_write (void *closure,
+                                            const unsigned char *data,
+                                            unsigned int length);
+
+/**
+ * A slope_write_func_t appending to the slope_buffer_t passed
+ * as closure.
+ */
+int __slope_export_buffer_write (void *closure,
+                                 const unsigned char *data,
+                                 unsigned int length);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_EXPORT_P_H */
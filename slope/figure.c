@@ -21,14 +21,22 @@
 #include "slope/metrics_p.h"
 #include "slope/xymetrics.h"
 #include "slope/legend_p.h"
-#include "slope/item.h"
+#include "slope/item_p.h"
 #include "slope/list.h"
+#include "slope/parallel_p.h"
 #include <stdlib.h>
+#include <string.h>
 #include <cairo.h>
 #include <cairo-svg.h>
 #include <cairo-pdf.h>
 #include <cairo-ps.h>
 
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
 
 slope_figure_t* slope_figure_create()
 {
@@ -39,6 +47,19 @@ slope_figure_t* slope_figure_create()
     figure->legend = slope_legend_create();
     slope_color_set_name(&figure->back_color, SLOPE_WHITE);
     figure->fill_back = SLOPE_TRUE;
+    figure->use_layers = SLOPE_TRUE;
+    figure->revision = 0;
+    figure->bands = SLOPE_FIGURE_BANDS_OFF;
+    figure->stats_enabled = SLOPE_FALSE;
+    figure->stats_depth = 0;
+    figure->stats_current = -1;
+    figure->stats_nalloc = 0;
+    figure->stats_update = 0.0;
+    figure->stats_items = NULL;
+    memset(&figure->stats, 0, sizeof(slope_figure_stats_t));
+    figure->stats_callback = NULL;
+    figure->stats_data = NULL;
+    __slope_glyph_cache_init(&figure->glyphs);
     return figure;
 }
 
@@ -48,6 +69,8 @@ void slope_figure_destroy (slope_figure_t *figure)
     if (figure == NULL) return;
     slope_item_destroy(figure->legend);
     slope_list_destroy(figure->metrics);
+    free(figure->stats_items);
+    __slope_glyph_cache_destroy(&figure->glyphs);
     free(figure);
 }
 
@@ -61,6 +84,8 @@ void slope_figure_add_metrics (slope_figure_t *figure,
     metrics->figure = figure;
     figure->metrics = slope_list_append(figure->metrics, metrics);
     figure->default_metrics = metrics;
+    __slope_figure_touch(figure);
+    __slope_figure_invalidate_legend(figure);
 
     if (figure->change_callback) {
         (*figure->change_callback)(figure);
@@ -75,9 +100,35 @@ slope_list_t* slope_figure_get_metrics_list (const slope_figure_t *figure)
 }
 
 
+/**
+ * Clears the stats for a new draw, except the draw count and the
+ * updates made since the last one.
+ */
+static void __slope_figure_stats_reset (slope_figure_t *figure)
+{
+    slope_figure_stats_t *stats = &figure->stats;
+    long draw_count = stats->draw_count;
+    memset(stats, 0, sizeof(slope_figure_stats_t));
+    stats->draw_count = draw_count;
+    stats->bands = 1;
+    stats->update_time = figure->stats_update;
+    stats->items = figure->stats_items;
+    figure->stats_update = 0.0;
+    figure->stats_current = -1;
+}
+
+
 void slope_figure_draw (slope_figure_t *figure, cairo_t *cr,
                         const slope_rect_t *rect)
 {
+    const int stats_on = __slope_figure_stats_on(figure);
+    double start = 0.0;
+    if (stats_on) {
+        __slope_figure_stats_hold(figure);
+        __slope_figure_stats_reset(figure);
+        start = __slope_figure_stats_clock();
+    }
+
     /* perform any pending drawing and clip to the figure's
        rectangle */
     cairo_stroke(cr);
@@ -115,9 +166,132 @@ void slope_figure_draw (slope_figure_t *figure, cairo_t *cr,
     slope_item_t *legend = figure->legend;
     if (slope_item_get_visible(legend)
         && figure->default_metrics != NULL) {
+            double legend_start = __slope_figure_stats_begin(figure);
             __slope_legend_draw(legend, cr, figure->default_metrics);
+            __slope_figure_stats_end(figure, legend_time, legend_start);
     }
     cairo_restore(cr);
+
+    if (stats_on) {
+        figure->stats.draw_time = __slope_figure_stats_clock() - start;
+        figure->stats.draw_count++;
+        __slope_figure_stats_release(figure);
+    }
+}
+
+
+/**
+ * A horizontal band of the output image, rendered by its own thread
+ * into a surface that aliases the band's rows.
+ */
+typedef struct _slope_figure_band_job
+{
+    slope_figure_t *figure;
+    unsigned char *data;
+    int stride;
+    int width;
+    int height;
+    int first_row;
+    int rows;
+} slope_figure_band_job_t;
+
+
+static void __slope_figure_draw_band (slope_figure_band_job_t *job,
+                                      int y, int rows)
+{
+    cairo_surface_t *surf = cairo_image_surface_create_for_data(
+        job->data + (size_t) y * job->stride, CAIRO_FORMAT_ARGB32,
+        job->width, rows, job->stride);
+    cairo_t *cr = cairo_create(surf);
+    slope_rect_t rect;
+    slope_rect_set(&rect, 0.0, 0.0, job->width, job->height);
+    cairo_translate(cr, 0.0, -y);
+    slope_figure_draw(job->figure, cr, &rect);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surf);
+}
+
+
+static void __slope_figure_band_task (void *data, int index)
+{
+    slope_figure_band_job_t *job = (slope_figure_band_job_t*) data;
+    int y = job->first_row + index*job->rows;
+    int rows = job->height - y;
+    if (rows > job->rows) rows = job->rows;
+    if (rows > 0) {
+        __slope_figure_draw_band(job, y, rows);
+    }
+}
+
+
+void __slope_figure_draw_image (slope_figure_t *figure,
+                                cairo_surface_t *surf, int nthreads)
+{
+    const int width = cairo_image_surface_get_width(surf);
+    const int height = cairo_image_surface_get_height(surf);
+    int nbands = nthreads;
+    if (nbands > height/SLOPE_FIGURE_BAND_MIN_ROWS - 1)
+        nbands = height/SLOPE_FIGURE_BAND_MIN_ROWS - 1;
+
+    if (nbands < 2 || cairo_surface_status(surf) != CAIRO_STATUS_SUCCESS) {
+        cairo_t *cr = cairo_create(surf);
+        slope_rect_t rect;
+        slope_rect_set(&rect, 0.0, 0.0, width, height);
+        slope_figure_draw(figure, cr, &rect);
+        cairo_destroy(cr);
+    }
+    else {
+        slope_figure_band_job_t job;
+        const int stats_on = __slope_figure_stats_on(figure);
+        double start = 0.0;
+        if (stats_on) {
+            __slope_figure_stats_hold(figure);
+            start = __slope_figure_stats_clock();
+        }
+        cairo_surface_flush(surf);
+        job.figure = figure;
+        job.data = cairo_image_surface_get_data(surf);
+        job.stride = cairo_image_surface_get_stride(surf);
+        job.width = width;
+        job.height = height;
+        job.first_row = SLOPE_FIGURE_BAND_MIN_ROWS;
+        job.rows = (height - job.first_row + nbands - 1) / nbands;
+
+        /* the first band lays out metrics and legend, the others
+           only read that layout, so they can run concurrently */
+        figure->bands = SLOPE_FIGURE_BANDS_FIRST;
+        __slope_figure_draw_band(&job, 0, job.first_row);
+        figure->bands = SLOPE_FIGURE_BANDS_REST;
+        __slope_parallel_for(__slope_figure_band_task, &job, nbands);
+        figure->bands = SLOPE_FIGURE_BANDS_OFF;
+        cairo_surface_mark_dirty(surf);
+
+        if (stats_on) {
+            /* the first band timed only its own rows of the axes,
+               items and legend, the layout and counts are whole */
+            int k;
+            figure->stats.axis_time = 0.0;
+            figure->stats.item_time = 0.0;
+            figure->stats.legend_time = 0.0;
+            for (k=0; k<figure->stats.nitems; k++) {
+                figure->stats_items[k].draw_time = 0.0;
+            }
+            figure->stats.draw_time = __slope_figure_stats_clock() - start;
+            figure->stats.bands = nbands + 1;
+            __slope_figure_stats_release(figure);
+        }
+    }
+}
+
+
+cairo_surface_t* __slope_figure_rasterize (slope_figure_t *figure,
+                                           int width, int height,
+                                           int nthreads)
+{
+    cairo_surface_t *surf = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, width, height);
+    __slope_figure_draw_image(figure, surf, nthreads);
+    return surf;
 }
 
 
@@ -125,15 +299,16 @@ void slope_figure_write_to_png (slope_figure_t *figure,
                                 const char *filename,
                                 int width, int height)
 {
-    cairo_surface_t *surf = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height);
-    cairo_t *cr = cairo_create(surf);
-    slope_rect_t rect;
-    slope_rect_set(&rect, 0.0, 0.0, width, height);
-    slope_figure_draw(figure, cr, &rect);
+    __slope_figure_stats_hold(figure);
+    cairo_surface_t *surf = __slope_figure_rasterize(
+        figure, width, height, __slope_parallel_ncpu());
+    double start = __slope_figure_stats_clock();
     cairo_surface_write_to_png(surf, filename);
-    cairo_destroy(cr);
+    if (figure != NULL && figure->stats_enabled) {
+        figure->stats.encode_time = __slope_figure_stats_clock() - start;
+    }
     cairo_surface_destroy(surf);
+    __slope_figure_stats_release(figure);
 }
 
 
@@ -199,6 +374,42 @@ int slope_figure_write_to_ps (slope_figure_t *figure,
 }
 
 
+void slope_figure_set_use_layers (slope_figure_t *figure, int on)
+{
+    if (figure == NULL) return;
+    figure->use_layers = on;
+}
+
+
+void slope_figure_set_stats_enabled (slope_figure_t *figure, int on)
+{
+    if (figure == NULL) return;
+    if (on && figure->stats_enabled == SLOPE_FALSE) {
+        memset(&figure->stats, 0, sizeof(slope_figure_stats_t));
+        figure->stats_update = 0.0;
+        figure->stats_current = -1;
+    }
+    figure->stats_enabled = on ? SLOPE_TRUE : SLOPE_FALSE;
+}
+
+
+const slope_figure_stats_t* slope_figure_get_stats (const slope_figure_t *figure)
+{
+    if (figure == NULL || figure->stats_enabled == SLOPE_FALSE) return NULL;
+    return &figure->stats;
+}
+
+
+void slope_figure_set_stats_callback (slope_figure_t *figure,
+                                      slope_stats_callback_t callback,
+                                      void *data)
+{
+    if (figure == NULL) return;
+    figure->stats_callback = callback;
+    figure->stats_data = data;
+}
+
+
 slope_metrics_t* slope_figure_get_default_metrics (slope_figure_t *figure)
 {
     if (figure == NULL) return NULL;
@@ -219,6 +430,9 @@ void slope_figure_notify_appearence_change (slope_figure_t *figure,
 {
     if (figure == NULL) return;
     (void) item; /* reserved for possible future use */
+    __slope_figure_touch(figure);
+    /* names, visibility and membership of items change through here */
+    __slope_figure_invalidate_legend(figure);
     
     if (figure->change_callback) {
         (*figure->change_callback)(figure);
@@ -233,6 +447,7 @@ void slope_figure_notify_data_change (slope_figure_t *figure,
         
     slope_metrics_t *metrics = slope_item_get_metrics(item);
     slope_metrics_update(metrics);
+    __slope_figure_touch(figure);
     if (figure->change_callback) {
         (*figure->change_callback)(figure);
     }
@@ -291,6 +506,147 @@ void slope_figure_update (slope_figure_t *figure)
         }
         slope_iterator_next(&metr_iter);
     }
+    /* the data may have been edited in place, without the metrics
+       range moving, so the retained item layers can't be trusted */
+    __slope_figure_invalidate_layers(figure);
+}
+
+
+void __slope_figure_touch (slope_figure_t *figure)
+{
+    if (figure == NULL) return;
+    figure->revision++;
+}
+
+
+void __slope_figure_invalidate_layers (slope_figure_t *figure)
+{
+    if (figure == NULL) return;
+
+    slope_iterator_t *metr_iter =
+        slope_list_first(figure->metrics);
+    while (metr_iter) {
+        slope_metrics_t *metrics =
+            slope_iterator_data(metr_iter);
+        slope_iterator_t *item_iter =
+            slope_list_first(slope_metrics_get_item_list(metrics));
+        while (item_iter) {
+            __slope_item_invalidate_layer(
+                (slope_item_t*) slope_iterator_data(item_iter));
+            slope_iterator_next(&item_iter);
+        }
+        slope_iterator_next(&metr_iter);
+    }
+    __slope_figure_touch(figure);
+}
+
+
+void __slope_figure_invalidate_legend (slope_figure_t *figure)
+{
+    if (figure == NULL) return;
+    __slope_legend_invalidate(figure->legend);
+}
+
+
+void __slope_figure_show_text (slope_figure_t *figure, cairo_t *cr,
+                               const char *text)
+{
+    const slope_glyph_run_t *run = NULL;
+    /* cairo_show_text() does nothing for these either, unnamed
+       items reach here with no text */
+    if (text == NULL || text[0] == '\0') return;
+    if (figure != NULL && __slope_item_target_is_raster(cr)) {
+        /* concurrent bands only look up the runs of the first one */
+        run = __slope_glyph_cache_get(
+            &figure->glyphs, cairo_get_scaled_font(cr), text,
+            __slope_figure_geometry_frozen(figure) == SLOPE_FALSE);
+    }
+    if (run == NULL) {
+        cairo_show_text(cr, text);
+        return;
+    }
+    double x, y;
+    cairo_get_current_point(cr, &x, &y);
+    __slope_glyph_run_show(run, cr, x, y);
+}
+
+
+double __slope_figure_stats_clock (void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec*1e-9;
+#endif
+}
+
+
+void __slope_figure_stats_hold (slope_figure_t *figure)
+{
+    if (figure == NULL || figure->stats_enabled == SLOPE_FALSE) return;
+    figure->stats_depth++;
+}
+
+
+void __slope_figure_stats_release (slope_figure_t *figure)
+{
+    if (figure == NULL || figure->stats_depth == 0) return;
+    if (--figure->stats_depth == 0 && figure->stats_enabled
+        && figure->stats_callback) {
+        (*figure->stats_callback)(figure, &figure->stats,
+                                  figure->stats_data);
+    }
+}
+
+
+void __slope_figure_stats_item_begin (slope_figure_t *figure,
+                                      const slope_item_t *item)
+{
+    if (__slope_figure_stats_on(figure) == SLOPE_FALSE) return;
+    slope_figure_stats_t *stats = &figure->stats;
+    if (stats->nitems == figure->stats_nalloc) {
+        int nalloc = figure->stats_nalloc ? 2*figure->stats_nalloc : 8;
+        slope_item_stats_t *items = realloc(
+            figure->stats_items, nalloc*sizeof(slope_item_stats_t));
+        if (items == NULL) return;
+        figure->stats_items = items;
+        figure->stats_nalloc = nalloc;
+        stats->items = items;
+    }
+    slope_item_stats_t *record = &figure->stats_items[stats->nitems];
+    record->item = item;
+    record->draw_time = 0.0;
+    record->points_in = 0;
+    record->points_drawn = 0;
+    figure->stats_current = stats->nitems++;
+}
+
+
+void __slope_figure_stats_item_end (slope_figure_t *figure, double start)
+{
+    if (__slope_figure_stats_on(figure) == SLOPE_FALSE) return;
+    double elapsed = __slope_figure_stats_clock() - start;
+    if (figure->stats_current >= 0) {
+        figure->stats_items[figure->stats_current].draw_time = elapsed;
+    }
+    figure->stats.item_time += elapsed;
+    figure->stats_current = -1;
+}
+
+
+void __slope_figure_stats_count (slope_figure_t *figure,
+                                 long points_in, long points_drawn)
+{
+    if (__slope_figure_stats_on(figure) == SLOPE_FALSE) return;
+    if (figure->stats_current < 0) return;
+    slope_item_stats_t *record = &figure->stats_items[figure->stats_current];
+    record->points_in += points_in;
+    record->points_drawn += points_drawn;
 }
 
 /* slope/figure.h */
@@ -42,6 +42,51 @@
 
 SLOPE_BEGIN_DECLS
 
+/**
+ * @ingroup Figure
+ * @brief Render statistics of one item in the last draw.
+ */
+typedef struct _slope_item_stats
+{
+    const slope_item_t *item;
+    double draw_time;    /* seconds in the item's draw function */
+    long points_in;      /* points in the visible range */
+    long points_drawn;   /* points left after decimation */
+}
+slope_item_stats_t;
+
+/**
+ * @ingroup Figure
+ * @brief Render statistics of the last draw of a figure. Times are
+ * in seconds. When the figure is rasterized in bands, which draw
+ * concurrently, the axis, item and legend times are 0, while
+ * draw_time, update_time, legend_geometry_time and the point counts
+ * still cover the whole draw.
+ */
+typedef struct _slope_figure_stats
+{
+    long draw_count;             /* draws since stats were enabled */
+    int bands;                   /* bands of the last draw */
+    double draw_time;            /* whole draw */
+    double update_time;          /* metrics updates since the draw before */
+    double axis_time;            /* drawing axes */
+    double item_time;            /* drawing items */
+    double legend_geometry_time; /* laying out the legend */
+    double legend_time;          /* drawing the legend, layout included */
+    double encode_time;          /* encoding, for exports and PNG files */
+    int nitems;
+    const slope_item_stats_t *items;
+}
+slope_figure_stats_t;
+
+/**
+ * @ingroup Figure
+ * @brief Called each time render statistics are complete.
+ */
+typedef void (*slope_stats_callback_t) (slope_figure_t *figure,
+                                        const slope_figure_stats_t *stats,
+                                        void *data);
+
 /**
  * @ingroup Figure
  * @brief Creates a new figure object.
@@ -90,6 +135,9 @@ slope_figure_draw (slope_figure_t *figure, cairo_t *cr,
  * @ingroup Figure
  * @brief Writes the figure to a png file
  * 
+ * Tall images are rasterized in horizontal bands, one thread per
+ * processor. Don't modify the figure from other threads meanwhile.
+ *
  * @param[in] figure The figure to be drawn
  * @param[in] The figure to be drawn.
  * @param[in] filename The path to the png file to be output, include the .png ending.
@@ -149,6 +197,56 @@ slope_figure_write_to_ps (slope_figure_t *figure,
                           const char *filename,
                           int width, int height);
 
+/**
+ * @ingroup Figure
+ * @brief Turns on or off the retained layers of the figure's items.
+ * With them, which is the default, drawing the figure to a raster
+ * target only renders again the items that changed since the last
+ * draw, and composites the others from images kept by each item.
+ * 
+ * @param[in] figure The figure.
+ * @param[in] on SLOPE_TRUE to retain item layers.
+ */
+slope_public void
+slope_figure_set_use_layers (slope_figure_t *figure, int on);
+
+/**
+ * @ingroup Figure
+ * @brief Turns on or off the gathering of render statistics, off by
+ * default. Turning them on clears the previous ones.
+ * 
+ * @param[in] figure The figure.
+ * @param[in] on SLOPE_TRUE to time the phases of each draw.
+ */
+slope_public void
+slope_figure_set_stats_enabled (slope_figure_t *figure, int on);
+
+/**
+ * @ingroup Figure
+ * @brief Retrieves the render statistics of the last draw. The items
+ * array is valid until the next draw.
+ * 
+ * @param[in] figure The figure.
+ * 
+ * @return The statistics, or NULL if they are not enabled.
+ */
+slope_public const slope_figure_stats_t*
+slope_figure_get_stats (const slope_figure_t *figure);
+
+/**
+ * @ingroup Figure
+ * @brief Sets a callback to be called with the render statistics
+ * after each draw, or after encoding when the figure is exported.
+ * 
+ * @param[in] figure The figure.
+ * @param[in] callback The function to be called, or NULL.
+ * @param[in] data Passed to callback.
+ */
+slope_public void
+slope_figure_set_stats_callback (slope_figure_t *figure,
+                                 slope_stats_callback_t callback,
+                                 void *data);
+
 /**
  * @ingroup Figure
  * @brief Retrieves the default metrics of the figure, normaly the last to be inserted.
@@ -193,6 +291,8 @@ slope_figure_track_region (slope_figure_t *figure,
                            double x2, double y2);
 
 /**
+ * @brief Rescales the metrics to their items and renders everything
+ * again on the next draw, also after data was modified in place.
  */
 slope_public void
 slope_figure_update (slope_figure_t *figure);
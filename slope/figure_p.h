@@ -21,9 +21,52 @@
 #define SLOPE_SCENE_P_H
 
 #include "slope/figure.h"
+#include "slope/glyphs_p.h"
 
 SLOPE_BEGIN_DECLS
 
+/* states of a figure while it is rasterized in horizontal bands */
+#define SLOPE_FIGURE_BANDS_OFF    0 /* regular drawing */
+#define SLOPE_FIGURE_BANDS_FIRST  1 /* first band, lays out geometry */
+#define SLOPE_FIGURE_BANDS_REST   2 /* concurrent bands, read only */
+
+/* rows in the first band and in each of the concurrent ones */
+#define SLOPE_FIGURE_BAND_MIN_ROWS  64
+
+/**
+ * Layers and symbol sprites are shared between draws and can't be
+ * used while bands render concurrently.
+ */
+#define __slope_figure_shares_caches(figure) \
+    ((figure) == NULL || (figure)->bands == SLOPE_FIGURE_BANDS_OFF)
+
+/**
+ * Geometry laid out by the first band is reused by the others.
+ */
+#define __slope_figure_geometry_frozen(figure) \
+    ((figure) != NULL && (figure)->bands == SLOPE_FIGURE_BANDS_REST)
+
+/**
+ * Render statistics are gathered by regular draws and by the first
+ * band of banded ones only.
+ */
+#define __slope_figure_stats_on(figure) \
+    ((figure) != NULL && (figure)->stats_enabled \
+     && (figure)->bands != SLOPE_FIGURE_BANDS_REST)
+
+/**
+ * Starts timing a phase, to be ended by __slope_figure_stats_end()
+ * which adds the elapsed time to the given field of the stats.
+ */
+#define __slope_figure_stats_begin(figure) \
+    (__slope_figure_stats_on(figure) ? __slope_figure_stats_clock() : 0.0)
+
+#define __slope_figure_stats_end(figure, field, start) \
+    do { \
+        if (__slope_figure_stats_on(figure)) \
+            (figure)->stats.field += __slope_figure_stats_clock() - (start); \
+    } while (0)
+
 /**
  */
 struct _slope_figure
@@ -34,8 +77,94 @@ struct _slope_figure
     slope_callback_t change_callback;
     slope_color_t    back_color;
     int              fill_back;
+    int              use_layers;
+    int              revision;
+    int              bands;
+    int              stats_enabled;
+    int              stats_depth;
+    int              stats_current;
+    int              stats_nalloc;
+    double           stats_update;
+    slope_item_stats_t    *stats_items;
+    slope_figure_stats_t   stats;
+    slope_stats_callback_t stats_callback;
+    void                  *stats_data;
+    slope_glyph_cache_t    glyphs;
 };
 
+
+/**
+ * @brief Draws the figure over a whole ARGB32 image surface, in
+ * horizontal bands on up to nthreads threads.
+ */
+void __slope_figure_draw_image (slope_figure_t *figure,
+                                cairo_surface_t *surf, int nthreads);
+
+/**
+ * @brief Draws the figure into a new ARGB32 image surface.
+ */
+cairo_surface_t* __slope_figure_rasterize (slope_figure_t *figure,
+                                           int width, int height,
+                                           int nthreads);
+
+/**
+ * @brief Marks the figure's rendered appearance as out of date.
+ */
+void __slope_figure_touch (slope_figure_t *figure);
+
+/**
+ * @brief Drops the retained layers of all items, whose data may have
+ * been modified in place, and marks the figure out of date.
+ */
+void __slope_figure_invalidate_layers (slope_figure_t *figure);
+
+/**
+ * @brief Makes the legend list and measure its entries again, after
+ * items were added, removed, renamed, shown or hidden.
+ */
+void __slope_figure_invalidate_legend (slope_figure_t *figure);
+
+/**
+ * @brief Shows text at the current point like cairo_show_text(),
+ * reusing the glyphs converted by previous draws on raster targets.
+ * Vector targets get the text itself, so it stays searchable.
+ */
+void __slope_figure_show_text (slope_figure_t *figure, cairo_t *cr,
+                               const char *text);
+
+/**
+ * @brief Seconds elapsed on a monotonic clock.
+ */
+double __slope_figure_stats_clock (void);
+
+/**
+ * @brief Opens a scope, draws included, whose statistics are only
+ * reported to the callback when the outermost one closes.
+ */
+void __slope_figure_stats_hold (slope_figure_t *figure);
+
+/**
+ * @brief Closes a scope opened by __slope_figure_stats_hold().
+ */
+void __slope_figure_stats_release (slope_figure_t *figure);
+
+/**
+ * @brief Starts the record of an item, the one points are counted for.
+ */
+void __slope_figure_stats_item_begin (slope_figure_t *figure,
+                                      const slope_item_t *item);
+
+/**
+ * @brief Ends the record of the current item, started at start.
+ */
+void __slope_figure_stats_item_end (slope_figure_t *figure, double start);
+
+/**
+ * @brief Counts points of the current item.
+ */
+void __slope_figure_stats_count (slope_figure_t *figure,
+                                 long points_in, long points_drawn);
+
 SLOPE_END_DECLS
 
 #endif /*SLOPE_SCENE_P_H */
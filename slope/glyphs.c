@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/glyphs_p.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* runs up to this length are offset on the stack */
+#define SLOPE_GLYPHS_STACK 64
+
+
+static unsigned long __slope_glyph_hash (cairo_scaled_font_t *font,
+                                         const char *text)
+{
+    /* FNV-1a of the text, mixed with the font address */
+    unsigned long hash = 2166136261UL;
+    const unsigned char *c;
+    for (c=(const unsigned char*) text; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619UL;
+    }
+    hash ^= (unsigned long) ((uintptr_t) font >> 4) * 2654435761UL;
+    return hash;
+}
+
+
+void __slope_glyph_cache_init (slope_glyph_cache_t *cache)
+{
+    cache->buckets = NULL;
+    cache->nruns = 0;
+}
+
+
+void __slope_glyph_cache_clear (slope_glyph_cache_t *cache)
+{
+    if (cache->buckets == NULL) return;
+    int k;
+    for (k=0; k<SLOPE_GLYPHS_BUCKETS; k++) {
+        slope_glyph_run_t *run = cache->buckets[k];
+        while (run) {
+            slope_glyph_run_t *next = run->next;
+            cairo_glyph_free(run->glyphs);
+            cairo_scaled_font_destroy(run->font);
+            free(run->text);
+            free(run);
+            run = next;
+        }
+        cache->buckets[k] = NULL;
+    }
+    cache->nruns = 0;
+}
+
+
+void __slope_glyph_cache_destroy (slope_glyph_cache_t *cache)
+{
+    __slope_glyph_cache_clear(cache);
+    free(cache->buckets);
+    cache->buckets = NULL;
+}
+
+
+const slope_glyph_run_t*
+__slope_glyph_cache_get (slope_glyph_cache_t *cache,
+                         cairo_scaled_font_t *font,
+                         const char *text, int insert)
+{
+    unsigned long hash = __slope_glyph_hash(font, text);
+    slope_glyph_run_t *run;
+
+    if (cache->buckets) {
+        run = cache->buckets[hash % SLOPE_GLYPHS_BUCKETS];
+        while (run) {
+            if (run->hash == hash && run->font == font
+                    && strcmp(run->text, text) == 0) {
+                return run;
+            }
+            run = run->next;
+        }
+    }
+    if (insert == SLOPE_FALSE) return NULL;
+
+    if (cache->buckets == NULL) {
+        cache->buckets = calloc(SLOPE_GLYPHS_BUCKETS,
+                                sizeof(slope_glyph_run_t*));
+        if (cache->buckets == NULL) return NULL;
+    }
+    if (cache->nruns >= SLOPE_GLYPHS_MAX_RUNS) {
+        __slope_glyph_cache_clear(cache);
+    }
+
+    cairo_glyph_t *glyphs = NULL;
+    int nglyphs = 0;
+    if (cairo_scaled_font_text_to_glyphs(
+            font, 0.0, 0.0, text, -1, &glyphs, &nglyphs,
+            NULL, NULL, NULL) != CAIRO_STATUS_SUCCESS) {
+        return NULL;
+    }
+    run = malloc(sizeof(slope_glyph_run_t));
+    char *copy = strdup(text);
+    if (run == NULL || copy == NULL) {
+        /* the text is shown without the cache */
+        free(copy);
+        free(run);
+        cairo_glyph_free(glyphs);
+        return NULL;
+    }
+    run->hash = hash;
+    run->font = cairo_scaled_font_reference(font);
+    run->text = copy;
+    run->glyphs = glyphs;
+    run->nglyphs = nglyphs;
+    run->next = cache->buckets[hash % SLOPE_GLYPHS_BUCKETS];
+    cache->buckets[hash % SLOPE_GLYPHS_BUCKETS] = run;
+    cache->nruns += 1;
+    return run;
+}
+
+
+void __slope_glyph_run_show (const slope_glyph_run_t *run, cairo_t *cr,
+                             double x, double y)
+{
+    cairo_glyph_t stack[SLOPE_GLYPHS_STACK];
+    cairo_glyph_t *glyphs = stack;
+    int k;
+
+    if (run->nglyphs < 1) return;
+    if (run->nglyphs > SLOPE_GLYPHS_STACK) {
+        glyphs = malloc(run->nglyphs*sizeof(cairo_glyph_t));
+        if (glyphs == NULL) return;
+    }
+    for (k=0; k<run->nglyphs; k++) {
+        glyphs[k].index = run->glyphs[k].index;
+        glyphs[k].x = run->glyphs[k].x + x;
+        glyphs[k].y = run->glyphs[k].y + y;
+    }
+    cairo_show_glyphs(cr, glyphs, run->nglyphs);
+    if (glyphs != stack) free(glyphs);
+}
+
+/* slope/glyphs.c */
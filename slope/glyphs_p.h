@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_GLYPHS_P_H
+#define SLOPE_GLYPHS_P_H
+
+#include "slope/primitives.h"
+
+SLOPE_BEGIN_DECLS
+
+#define SLOPE_GLYPHS_BUCKETS  256
+
+/* the cache starts over once it holds that many runs */
+#define SLOPE_GLYPHS_MAX_RUNS 1024
+
+/**
+ * A string converted to glyphs of a scaled font, positioned from an
+ * origin at 0,0.
+ */
+typedef struct _slope_glyph_run slope_glyph_run_t;
+
+struct _slope_glyph_run
+{
+    slope_glyph_run_t *next;
+    unsigned long hash;
+    cairo_scaled_font_t *font;
+    char *text;
+    cairo_glyph_t *glyphs;
+    int nglyphs;
+};
+
+/**
+ * Glyph runs keyed by string and scaled font. The cache holds a
+ * reference to each font, so their addresses can't be reused.
+ */
+typedef struct _slope_glyph_cache
+{
+    slope_glyph_run_t **buckets;
+    int nruns;
+}
+slope_glyph_cache_t;
+
+/**
+ */
+void __slope_glyph_cache_init (slope_glyph_cache_t *cache);
+
+/**
+ */
+void __slope_glyph_cache_destroy (slope_glyph_cache_t *cache);
+
+/**
+ * Drops every run of the cache.
+ */
+void __slope_glyph_cache_clear (slope_glyph_cache_t *cache);
+
+/**
+ * Finds the run of text in font. On a miss, if insert is SLOPE_TRUE,
+ * converts text and adds its run, otherwise returns NULL. Lookups
+ * without insertion may run concurrently.
+ */
+const slope_glyph_run_t*
+__slope_glyph_cache_get (slope_glyph_cache_t *cache,
+                         cairo_scaled_font_t *font,
+                         const char *text, int insert);
+
+/**
+ * Shows the glyphs of run with their origin at x,y.
+ */
+void __slope_glyph_run_show (const slope_glyph_run_t *run, cairo_t *cr,
+                             double x, double y);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_GLYPHS_P_H */
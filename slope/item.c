@@ -18,10 +18,14 @@
  */
 
 #include "slope/item_p.h"
-#include "slope/metrics.h"
-#include "slope/figure.h"
+#include "slope/metrics_p.h"
+#include "slope/figure_p.h"
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+
+
+static const cairo_user_data_key_t __slope_item_raster_key = { 0 };
 
 
 void slope_item_destroy (slope_item_t *item)
@@ -35,6 +39,9 @@ void slope_item_destroy (slope_item_t *item)
     if (item->name) {
         free(item->name);
     }
+    if (item->layer) {
+        cairo_surface_destroy(item->layer);
+    }
     free(item);
 }
 
@@ -122,6 +129,7 @@ slope_figure_t* slope_item_get_figure (const slope_item_t *item)
 
 void slope_item_notify_appearence_change (slope_item_t *item)
 {
+    item->layer_dirty = SLOPE_TRUE;
     slope_figure_t *figure = slope_item_get_figure(item);
     slope_figure_notify_appearence_change(figure, item);
 }
@@ -129,11 +137,161 @@ void slope_item_notify_appearence_change (slope_item_t *item)
 
 void slope_item_notify_data_change (slope_item_t *item)
 {
+    item->layer_dirty = SLOPE_TRUE;
     slope_figure_t *figure = slope_item_get_figure(item);
     slope_figure_notify_data_change(figure, item);
 }
 
 
+void __slope_item_font_init (slope_item_font_t *font)
+{
+    font->face = NULL;
+    memset(font->matrix, 0, sizeof(font->matrix));
+}
+
+
+void __slope_item_font_clear (slope_item_font_t *font)
+{
+    if (font->face) {
+        cairo_font_face_destroy(font->face);
+    }
+    __slope_item_font_init(font);
+}
+
+
+int __slope_item_font_check (slope_item_font_t *font, cairo_t *cr)
+{
+    cairo_font_face_t *face = cairo_get_font_face(cr);
+    cairo_matrix_t font_matrix, ctm;
+    double key[8];
+    cairo_get_font_matrix(cr, &font_matrix);
+    cairo_get_matrix(cr, &ctm);
+    key[0] = font_matrix.xx;
+    key[1] = font_matrix.yx;
+    key[2] = font_matrix.xy;
+    key[3] = font_matrix.yy;
+    /* translations don't change extents, bands only translate */
+    key[4] = ctm.xx;
+    key[5] = ctm.yx;
+    key[6] = ctm.xy;
+    key[7] = ctm.yy;
+
+    if (face == font->face
+            && memcmp(key, font->matrix, sizeof(key)) == 0) {
+        return SLOPE_TRUE;
+    }
+    cairo_font_face_reference(face);
+    if (font->face) {
+        cairo_font_face_destroy(font->face);
+    }
+    font->face = face;
+    memcpy(font->matrix, key, sizeof(key));
+    return SLOPE_FALSE;
+}
+
+
+void __slope_item_init_layer (slope_item_t *item)
+{
+    item->layer = NULL;
+    item->layer_x = item->layer_y = 0;
+    item->layer_dirty = SLOPE_TRUE;
+    item->layer_revision = 0;
+}
+
+
+void __slope_item_invalidate_layer (slope_item_t *item)
+{
+    item->layer_dirty = SLOPE_TRUE;
+}
+
+
+void __slope_item_draw_layer (slope_item_t *item, cairo_t *cr,
+                              const slope_metrics_t *metrics)
+{
+    const slope_figure_t *figure = metrics->figure;
+    cairo_matrix_t ctm;
+    cairo_get_matrix(cr, &ctm);
+
+    /* a layer only gives the same pixels as drawing directly when
+       the pixel grids match, i.e. no transform but an integer shift */
+    if (figure == NULL || figure->use_layers == SLOPE_FALSE
+            || __slope_figure_shares_caches(figure) == SLOPE_FALSE
+            || __slope_item_target_is_raster(cr) == SLOPE_FALSE
+            || ctm.xx != 1.0 || ctm.yy != 1.0
+            || ctm.xy != 0.0 || ctm.yx != 0.0
+            || ctm.x0 != floor(ctm.x0) || ctm.y0 != floor(ctm.y0)) {
+        __slope_item_draw(item, cr, metrics);
+        return;
+    }
+
+    if (item->layer == NULL || item->layer_dirty
+            || item->layer_revision != metrics->revision) {
+        const int x = (int) floor(metrics->xmin_figure);
+        const int y = (int) floor(metrics->ymin_figure);
+        const int width = (int) ceil(metrics->xmax_figure) - x;
+        const int height = (int) ceil(metrics->ymax_figure) - y;
+        if (item->layer) {
+            cairo_surface_destroy(item->layer);
+            item->layer = NULL;
+        }
+        if (width < 1 || height < 1) {
+            return;
+        }
+        item->layer = cairo_surface_create_similar(
+            cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA, width, height);
+        cairo_surface_set_user_data(item->layer, &__slope_item_raster_key,
+                                    item->layer, NULL);
+        cairo_t *layer_cr = cairo_create(item->layer);
+        cairo_translate(layer_cr, -x, -y);
+        __slope_item_draw(item, layer_cr, metrics);
+        cairo_destroy(layer_cr);
+        item->layer_x = x;
+        item->layer_y = y;
+        item->layer_dirty = SLOPE_FALSE;
+        item->layer_revision = metrics->revision;
+    }
+
+    cairo_set_source_surface(cr, item->layer, item->layer_x, item->layer_y);
+    cairo_paint(cr);
+}
+
+
+int __slope_item_target_is_raster (cairo_t *cr)
+{
+    cairo_surface_t *target = cairo_get_target(cr);
+    /* layers may be similar surfaces of any backend */
+    if (cairo_surface_get_user_data(target, &__slope_item_raster_key)) {
+        return SLOPE_TRUE;
+    }
+    switch (cairo_surface_get_type(target)) {
+        case CAIRO_SURFACE_TYPE_IMAGE:
+        case CAIRO_SURFACE_TYPE_XLIB:
+        case CAIRO_SURFACE_TYPE_XCB:
+        case CAIRO_SURFACE_TYPE_WIN32:
+        case CAIRO_SURFACE_TYPE_QUARTZ:
+        case CAIRO_SURFACE_TYPE_QUARTZ_IMAGE:
+            return SLOPE_TRUE;
+        default:
+            return SLOPE_FALSE;
+    }
+}
+
+
+int __slope_item_pixel_aligned (cairo_t *cr)
+{
+    /* cairo_user_to_device() also applies the device transform of
+       the surface, e.g. a hi-DPI scale, which the CTM leaves out */
+    double ox = 0.0, oy = 0.0;
+    double ux = 1.0, uy = 0.0;
+    double vx = 0.0, vy = 1.0;
+    cairo_user_to_device(cr, &ox, &oy);
+    cairo_user_to_device(cr, &ux, &uy);
+    cairo_user_to_device(cr, &vx, &vy);
+    return ux - ox == 1.0 && uy == oy && vx == ox && vy - oy == 1.0
+        && ox == floor(ox) && oy == floor(oy);
+}
+
+
 int __slope_item_parse_color (const char *fmt)
 {
     while (*fmt) {
@@ -154,6 +312,8 @@ int __slope_item_parse_scatter (const char *fmt)
         if (*fmt == '-') return SLOPE_LINE;
         if (*fmt == '*') return SLOPE_CIRCLES;
         if (*fmt == '+') return SLOPE_PLUSSES;
+        if (*fmt == '^') return SLOPE_TRIANGLES;
+        if (*fmt == 's') return SLOPE_SQUARES;
         ++fmt;
     }
     return SLOPE_LINE;
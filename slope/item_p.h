@@ -29,6 +29,19 @@ SLOPE_BEGIN_DECLS
 typedef struct _slope_item_class slope_item_class_t;
 
 /**
+ * The font, and the scale of it, that some text was measured with.
+ * A reference to the face is held, so its address can't be reused.
+ */
+typedef struct _slope_item_font
+{
+    cairo_font_face_t *face;
+    double matrix[8];
+}
+slope_item_font_t;
+
+/**
+ * Each item type keeps a single statically initialized instance,
+ * so items can be created from concurrent threads.
  */
 struct _slope_item_class
 {
@@ -48,6 +61,11 @@ struct _slope_item
     char *name;
     int visible;
     int has_thumb;
+    /* retained rendering of the item, see __slope_item_draw_layer */
+    cairo_surface_t *layer;
+    int layer_x, layer_y;
+    int layer_dirty;
+    int layer_revision;
 };
 
 /**
@@ -56,6 +74,51 @@ void __slope_item_draw (slope_item_t *item, cairo_t *cr,
                         const slope_metrics_t *metrics);
 
 
+/**
+ */
+void __slope_item_init_layer (slope_item_t *item);
+
+/**
+ * Makes the next draw render the item's layer again, for data that
+ * was changed without the item being told.
+ */
+void __slope_item_invalidate_layer (slope_item_t *item);
+
+/**
+ * Draws the item through its retained layer, an image of the plot
+ * area of its metrics that is only rendered again when the item
+ * changed or the metrics transform did. Targets where a device pixel
+ * image could differ from drawing directly, like vector surfaces or
+ * scaled contexts, are drawn directly.
+ */
+void __slope_item_draw_layer (slope_item_t *item, cairo_t *cr,
+                              const slope_metrics_t *metrics);
+
+/**
+ * Tells if cr draws to pixels, as opposed to a vector surface.
+ */
+int __slope_item_target_is_raster (cairo_t *cr);
+
+/**
+ * Tells if user space pixels of cr are device pixels, i.e. user to
+ * device is at most a shift by whole pixels.
+ */
+int __slope_item_pixel_aligned (cairo_t *cr);
+
+/**
+ */
+void __slope_item_font_init (slope_item_font_t *font);
+
+/**
+ */
+void __slope_item_font_clear (slope_item_font_t *font);
+
+/**
+ * Checks whether cr still uses the font, otherwise makes the font of
+ * cr the one kept and returns SLOPE_FALSE.
+ */
+int __slope_item_font_check (slope_item_font_t *font, cairo_t *cr);
+
 /**
  */
 void __slope_item_draw_thumb (slope_item_t *item,
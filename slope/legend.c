@@ -28,15 +28,11 @@
 
 slope_item_class_t* __slope_legend_get_class()
 {
-    static int first_call = SLOPE_TRUE;
-    static slope_item_class_t klass;
-
-    if (first_call) {
-        klass.destroy_fn = NULL;
-        klass.draw_fn = __slope_legend_draw;
-        klass.draw_thumb_fn = NULL;
-        first_call = SLOPE_FALSE;
-    }
+    static slope_item_class_t klass = {
+        __slope_legend_destroy,
+        __slope_legend_draw,
+        NULL
+    };
 
     return &klass;
 }
@@ -48,26 +44,53 @@ slope_item_t* slope_legend_create ()
     slope_item_t *parent = (slope_item_t*) legend;
 
     parent->klass = __slope_legend_get_class();
+    parent->name = NULL;
+    parent->metrics = NULL;
     parent->visible = SLOPE_TRUE;
     parent->has_thumb = SLOPE_FALSE;
+    __slope_item_init_layer(parent);
     legend->position = SLOPE_LEGEND_TOPRIGHT;
 
     slope_color_set_name(&legend->fill_color, SLOPE_WHITE);
     slope_color_set_name(&legend->stroke_color, SLOPE_BLACK);
+
+    legend->entries = NULL;
+    legend->nentries = 0;
+    legend->entries_alloc = 0;
+    legend->layout_valid = SLOPE_FALSE;
+    __slope_item_font_init(&legend->font);
     
     return parent;
 }
 
 
-void __slope_legend_eval_geometry (slope_item_t *item, cairo_t *cr,
-                                   const slope_metrics_t *metrics)
+void __slope_legend_destroy (slope_item_t *item)
+{
+    slope_legend_t *self = (slope_legend_t*) item;
+    free(self->entries);
+    __slope_item_font_clear(&self->font);
+}
+
+
+void __slope_legend_invalidate (slope_item_t *item)
+{
+    if (item == NULL) return;
+    ((slope_legend_t*) item)->layout_valid = SLOPE_FALSE;
+}
+
+
+/**
+ * Lists the entries of the legend and measures them.
+ */
+static void __slope_legend_eval_entries (slope_item_t *item, cairo_t *cr,
+                                         slope_figure_t *figure)
 {
     slope_legend_t *self = (slope_legend_t*) item;
-    slope_figure_t *figure = slope_metrics_get_figure(metrics);
     
     double max_width = 0.0;
     self->rect.width = 0.0;
     self->rect.height = 0.0;
+    self->nentries = 0;
 
     slope_iterator_t *met_iter = slope_list_first(
         slope_figure_get_metrics_list(figure));
@@ -89,11 +112,30 @@ void __slope_legend_eval_geometry (slope_item_t *item, cairo_t *cr,
                     continue;
                 }
                 
+                /* without room for more entries, the legend keeps
+                   those it has */
+                if (self->nentries == self->entries_alloc) {
+                    int nalloc = self->entries_alloc
+                        ? 2*self->entries_alloc : 16;
+                    slope_legend_entry_t *entries = realloc(
+                        self->entries, nalloc*sizeof(slope_legend_entry_t));
+                    if (entries == NULL) {
+                        slope_iterator_next(&item_iter);
+                        continue;
+                    }
+                    self->entries = entries;
+                    self->entries_alloc = nalloc;
+                }
+
                 /* increment height and check for bigger width */
                 cairo_text_extents_t txt_ext;
                 cairo_text_extents(cr, slope_item_get_name(item), &txt_ext);
                 self->rect.height += txt_ext.height + 4.0;
                 if (txt_ext.width > max_width) max_width = txt_ext.width;
+
+                self->entries[self->nentries].item = item;
+                self->entries[self->nentries].offset = self->rect.height;
+                self->nentries += 1;
                 
             slope_iterator_next(&item_iter);
         }
@@ -102,6 +144,20 @@ void __slope_legend_eval_geometry (slope_item_t *item, cairo_t *cr,
     
     self->rect.width = max_width + 40.0;
     self->rect.height += 10.0;
+    self->layout_valid = SLOPE_TRUE;
+}
+
+
+void __slope_legend_eval_geometry (slope_item_t *item, cairo_t *cr,
+                                   const slope_metrics_t *metrics)
+{
+    slope_legend_t *self = (slope_legend_t*) item;
+    slope_figure_t *figure = slope_metrics_get_figure(metrics);
+
+    if (__slope_item_font_check(&self->font, cr) == SLOPE_FALSE
+            || self->layout_valid == SLOPE_FALSE) {
+        __slope_legend_eval_entries(item, cr, figure);
+    }
     
     switch (self->position) {
         case SLOPE_LEGEND_TOPRIGHT:
@@ -123,7 +179,11 @@ void __slope_legend_draw (slope_item_t *item, cairo_t *cr,
     slope_figure_t *figure = slope_metrics_get_figure(metrics);
     slope_rect_t *rec = &self->rect;
     
-    __slope_legend_eval_geometry(item, cr, metrics);
+    if (__slope_figure_geometry_frozen(figure) == SLOPE_FALSE) {
+        double start = __slope_figure_stats_begin(figure);
+        __slope_legend_eval_geometry(item, cr, metrics);
+        __slope_figure_stats_end(figure, legend_geometry_time, start);
+    }
     
     /* fill background */
     slope_cairo_set_color(cr, &self->fill_color);
@@ -136,41 +196,13 @@ void __slope_legend_draw (slope_item_t *item, cairo_t *cr,
     cairo_set_line_width(cr, 1.0);
     cairo_stroke(cr);
     
-    /* finaly draw the legend entries */
+    /* finaly draw the legend entries, delegating each one to its item */
     slope_point_t entry_pos;
     entry_pos.x = self->rect.x + 15.0;
-    entry_pos.y = self->rect.y;
-    
-    slope_iterator_t *met_iter = slope_list_first(
-        slope_figure_get_metrics_list(figure));
-    /* for each metrics in the figure */
-    while (met_iter) {
-        slope_metrics_t *metrics = (slope_metrics_t*)
-            slope_iterator_data(met_iter);
-        slope_iterator_t *item_iter = slope_list_first(
-            slope_metrics_get_item_list(metrics));
-        /* for each item in the metrics */
-        while (item_iter) {
-            slope_item_t *item = (slope_item_t*)
-                slope_iterator_data(item_iter);
-            const char *entry = slope_item_get_name(item);
-            
-            /* check if item is visible and has a legend thumb */
-            if (slope_item_get_visible(item) == SLOPE_FALSE
-            || slope_item_get_has_thumb(item) == SLOPE_FALSE) {
-                slope_iterator_next(&item_iter);
-                continue;
-            }
-
-            /* position pen and delegate entry drawing to the item */
-            cairo_text_extents_t txt_ext;
-            cairo_text_extents(cr, entry, &txt_ext);
-            entry_pos.y += txt_ext.height + 4.0;
-            __slope_item_draw_thumb(item, &entry_pos, cr);
-
-            slope_iterator_next(&item_iter);
-        }
-        slope_iterator_next(&met_iter);
+    int k;
+    for (k=0; k<self->nentries; k++) {
+        entry_pos.y = self->rect.y + self->entries[k].offset;
+        __slope_item_draw_thumb(self->entries[k].item, &entry_pos, cr);
     }
     cairo_stroke(cr);
 }
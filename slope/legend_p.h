@@ -27,6 +27,17 @@ SLOPE_BEGIN_DECLS
 
 typedef struct _slope_legend slope_legend_t;
 
+/**
+ * An entry of the legend, with the offset of its baseline from the
+ * top of the legend.
+ */
+typedef struct _slope_legend_entry
+{
+    slope_item_t *item;
+    double offset;
+}
+slope_legend_entry_t;
+
 struct _slope_legend
 {
     slope_item_t parent;
@@ -34,6 +45,13 @@ struct _slope_legend
     slope_color_t fill_color;
     slope_color_t stroke_color;
     slope_legend_position_t position;
+    /* entries and size of the legend, kept until an entry is added,
+       removed, renamed, shown or hidden, or the font changes */
+    slope_legend_entry_t *entries;
+    int nentries;
+    int entries_alloc;
+    int layout_valid;
+    slope_item_font_t font;
 };
 
 /**
@@ -41,6 +59,15 @@ struct _slope_legend
 slope_item_class_t* __slope_legend_get_class();
 
 
+/**
+ */
+void __slope_legend_destroy (slope_item_t *legend);
+
+/**
+ * Drops the layout of the entries, to be made again by the next draw.
+ */
+void __slope_legend_invalidate (slope_item_t *legend);
+
 /**
  */
 void __slope_legend_draw (slope_item_t *legend, cairo_t *cr,
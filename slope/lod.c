@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/lod_p.h"
+#include "slope/dataview_p.h"
+#include <stdlib.h>
+#include <math.h>
+
+
+void __slope_lod_init (slope_lod_t *lod)
+{
+    lod->nlevels = 0;
+}
+
+
+void __slope_lod_clear (slope_lod_t *lod)
+{
+    int k;
+    for (k=0; k<lod->nlevels; k++) {
+        free(lod->level[k]);
+    }
+    lod->nlevels = 0;
+}
+
+
+static slope_lod_entry_t* __slope_lod_reserve (slope_lod_t *lod,
+                                               int level, int count)
+{
+    /* levels grow geometrically, so appending points one at a time
+       doesn't reallocate every level on every update */
+    if (level >= lod->nlevels) {
+        lod->level[level] = NULL;
+        lod->alloc[level] = 0;
+    }
+    if (count > lod->alloc[level]) {
+        int alloc = 2*lod->alloc[level];
+        if (alloc < count) alloc = count;
+        slope_lod_entry_t *entries = realloc(
+            lod->level[level], (size_t) alloc*sizeof(slope_lod_entry_t));
+        if (entries == NULL) return NULL;
+        lod->level[level] = entries;
+        lod->alloc[level] = alloc;
+    }
+    return lod->level[level];
+}
+
+
+/**
+ * Frees the pyramid after failing to reserve the given level, which
+ * may be above the levels it had before.
+ */
+static int __slope_lod_fail (slope_lod_t *lod, int level)
+{
+    if (level >= lod->nlevels) lod->nlevels = level + 1;
+    __slope_lod_clear(lod);
+    return SLOPE_ERROR;
+}
+
+
+#define __slope_lod_value(view, doubles, k) \
+    ((doubles) ? (doubles)[k] : __slope_dataview_at(view, k))
+
+
+int __slope_lod_build (slope_lod_t *lod, const slope_dataview_t *vy, int n)
+{
+    __slope_lod_clear(lod);
+    return __slope_lod_update(lod, vy, n, 0);
+}
+
+
+int __slope_lod_update (slope_lod_t *lod, const slope_dataview_t *vy,
+                        int n, int from)
+{
+    if (n < SLOPE_LOD_MIN_SIZE) {
+        __slope_lod_clear(lod);
+        return SLOPE_SUCCESS;
+    }
+    if (lod->nlevels == 0 || from < 0) from = 0;
+
+    /* level 0 summarizes the samples themselves, ties keep the
+       first index so the pyramid agrees with a linear scan */
+    const int bsize = __slope_lod_block_size(0);
+    const double *dv = __slope_dataview_doubles(vy);
+    double y[__slope_lod_block_size(0)];
+    int count = (n + bsize - 1) /bsize;
+    int first = from /bsize;
+    slope_lod_entry_t *level = __slope_lod_reserve(lod, 0, count);
+    int b, k, nlevels;
+    if (level == NULL) return __slope_lod_fail(lod, 0);
+    for (b=first; b<count; b++) {
+        int start = b*bsize;
+        int stop = start + bsize;
+        if (stop > n) stop = n;
+        int imin = 0, imax = 0;
+        __slope_dataview_fetch(vy, start, stop - start, y);
+        for (k=0; k<stop-start; k++) {
+            if (!isfinite(y[k])) {
+                imin = imax = SLOPE_LOD_GAP - start;
+                break;
+            }
+            if (y[k] < y[imin]) imin = k;
+            if (y[k] > y[imax]) imax = k;
+        }
+        level[b].imin = start + imin;
+        level[b].imax = start + imax;
+    }
+    lod->level[0] = level;
+    lod->count[0] = count;
+    nlevels = 1;
+
+    /* each upper level merges pairs of blocks of the one below,
+       only the parents of the blocks redone need to change */
+    while (count > 1 && nlevels < SLOPE_LOD_MAX_LEVELS) {
+        const slope_lod_entry_t *below = lod->level[nlevels-1];
+        const int nbelow = count;
+        count = (nbelow + 1) /2;
+        first = nlevels < lod->nlevels ? first/2 : 0;
+        level = __slope_lod_reserve(lod, nlevels, count);
+        if (level == NULL) return __slope_lod_fail(lod, nlevels);
+        for (b=first; b<count; b++) {
+            const slope_lod_entry_t *e1 = &below[2*b];
+            level[b] = *e1;
+            if (2*b+1 < nbelow) {
+                const slope_lod_entry_t *e2 = &below[2*b+1];
+                if (e1->imin == SLOPE_LOD_GAP || e2->imin == SLOPE_LOD_GAP) {
+                    level[b].imin = level[b].imax = SLOPE_LOD_GAP;
+                    continue;
+                }
+                if (__slope_lod_value(vy, dv, e2->imin)
+                        < __slope_lod_value(vy, dv, e1->imin)) {
+                    level[b].imin = e2->imin;
+                }
+                if (__slope_lod_value(vy, dv, e2->imax)
+                        > __slope_lod_value(vy, dv, e1->imax)) {
+                    level[b].imax = e2->imax;
+                }
+            }
+        }
+        lod->level[nlevels] = level;
+        lod->count[nlevels] = count;
+        nlevels += 1;
+    }
+
+    /* levels left over from a bigger data set */
+    for (k=nlevels; k<lod->nlevels; k++) {
+        free(lod->level[k]);
+    }
+    lod->nlevels = nlevels;
+    return SLOPE_SUCCESS;
+}
+
+void __slope_lod_builder_init (slope_lod_builder_t *builder,
+                               slope_lod_t *lod, int n)
+{
+    __slope_lod_clear(lod);
+    builder->lod = lod;
+    builder->n = n;
+    if (n < SLOPE_LOD_MIN_SIZE) return;
+
+    /* the shape of the pyramid only depends on n */
+    int count = (n + __slope_lod_block_size(0) - 1) /__slope_lod_block_size(0);
+    if (__slope_lod_reserve(lod, 0, count) == NULL) {
+        __slope_lod_fail(lod, 0);
+        return;
+    }
+    lod->count[0] = count;
+    lod->nlevels = 1;
+    while (count > 1 && lod->nlevels < SLOPE_LOD_MAX_LEVELS) {
+        count = (count + 1) /2;
+        if (__slope_lod_reserve(lod, lod->nlevels, count) == NULL) {
+            /* feeding an empty pyramid does nothing */
+            __slope_lod_fail(lod, lod->nlevels);
+            return;
+        }
+        lod->count[lod->nlevels] = count;
+        lod->nlevels += 1;
+    }
+}
+
+
+static void __slope_lod_builder_emit (slope_lod_builder_t *builder,
+                                      int l, int b, slope_lod_entry_t entry,
+                                      double vmin, double vmax)
+{
+    slope_lod_t *lod = builder->lod;
+    lod->level[l][b] = entry;
+    if (l+1 >= lod->nlevels) return;
+
+    /* an even block waits for its sibling, unless it is the last */
+    if (b%2 == 0) {
+        if (b == lod->count[l]-1) {
+            __slope_lod_builder_emit(builder, l+1, b/2, entry, vmin, vmax);
+            return;
+        }
+        builder->pending[l] = entry;
+        builder->pmin[l] = vmin;
+        builder->pmax[l] = vmax;
+        return;
+    }
+
+    slope_lod_entry_t merged = builder->pending[l];
+    double mmin = builder->pmin[l];
+    double mmax = builder->pmax[l];
+    if (merged.imin == SLOPE_LOD_GAP || entry.imin == SLOPE_LOD_GAP) {
+        merged.imin = merged.imax = SLOPE_LOD_GAP;
+    }
+    else {
+        if (vmin < mmin) {
+            merged.imin = entry.imin;
+            mmin = vmin;
+        }
+        if (vmax > mmax) {
+            merged.imax = entry.imax;
+            mmax = vmax;
+        }
+    }
+    __slope_lod_builder_emit(builder, l+1, b/2, merged, mmin, mmax);
+}
+
+
+void __slope_lod_builder_feed (slope_lod_builder_t *builder,
+                               const double *vy, int start, int count)
+{
+    if (builder->lod->nlevels == 0) return;
+    const int bsize = __slope_lod_block_size(0);
+    int offset, k;
+
+    for (offset=0; offset<count; offset+=bsize) {
+        int stop = offset + bsize;
+        if (stop > count) stop = count;
+        slope_lod_entry_t entry;
+        int imin = offset, imax = offset;
+        for (k=offset; k<stop; k++) {
+            if (!isfinite(vy[k])) {
+                imin = imax = -1;
+                break;
+            }
+            if (vy[k] < vy[imin]) imin = k;
+            if (vy[k] > vy[imax]) imax = k;
+        }
+        if (imin < 0) {
+            entry.imin = entry.imax = SLOPE_LOD_GAP;
+            __slope_lod_builder_emit(builder, 0, (start + offset)/bsize,
+                                     entry, 0.0, 0.0);
+            continue;
+        }
+        entry.imin = start + imin;
+        entry.imax = start + imax;
+        __slope_lod_builder_emit(builder, 0, (start + offset)/bsize,
+                                 entry, vy[imin], vy[imax]);
+    }
+}
+
+/* slope/lod.c */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_LOD_P_H
+#define SLOPE_LOD_P_H
+
+#include "slope/dataview.h"
+#include "slope/primitives.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * log2 of the number of samples summarized by a level 0 block,
+ * level k blocks cover 2^(SLOPE_LOD_SHIFT+k) samples.
+ */
+#define SLOPE_LOD_SHIFT 4
+
+/**
+ * Data sets smaller than this are not worth a pyramid.
+ */
+#define SLOPE_LOD_MIN_SIZE 4096
+
+/**
+ */
+#define SLOPE_LOD_MAX_LEVELS 28
+
+/**
+ * Index stored in the entries of blocks holding NaN or infinite
+ * samples, those are gaps in the plot and must be walked sample
+ * by sample.
+ */
+#define SLOPE_LOD_GAP (-1)
+
+/**
+ * Indices of the minimum and maximum y of a block of samples,
+ * the x span of the block comes from its first and last samples.
+ */
+typedef struct _slope_lod_entry
+{
+    int imin;
+    int imax;
+}
+slope_lod_entry_t;
+
+/**
+ * Multi-resolution min/max pyramid over a data set.
+ */
+typedef struct _slope_lod
+{
+    int nlevels;
+    int count[SLOPE_LOD_MAX_LEVELS];
+    int alloc[SLOPE_LOD_MAX_LEVELS];
+    slope_lod_entry_t *level[SLOPE_LOD_MAX_LEVELS];
+}
+slope_lod_t;
+
+/**
+ * State of a pyramid built in a single pass over the samples, for
+ * data that is expensive to read more than once. Each level keeps the
+ * last even block still waiting for its sibling, with its values.
+ */
+typedef struct _slope_lod_builder
+{
+    slope_lod_t       *lod;
+    int                n;
+    slope_lod_entry_t  pending[SLOPE_LOD_MAX_LEVELS];
+    double             pmin[SLOPE_LOD_MAX_LEVELS];
+    double             pmax[SLOPE_LOD_MAX_LEVELS];
+}
+slope_lod_builder_t;
+
+/**
+ */
+void __slope_lod_init (slope_lod_t *lod);
+
+/**
+ */
+void __slope_lod_clear (slope_lod_t *lod);
+
+/**
+ * Builds the pyramid over the n values of vy, replacing any
+ * previous one. If out of memory, the pyramid is left empty and
+ * SLOPE_ERROR is returned.
+ */
+int __slope_lod_build (slope_lod_t *lod, const slope_dataview_t *vy, int n);
+
+/**
+ * Brings the pyramid up to date with the n values of vy when only
+ * those from index from on changed or were appended. Fails like
+ * __slope_lod_build().
+ */
+int __slope_lod_update (slope_lod_t *lod, const slope_dataview_t *vy,
+                        int n, int from);
+
+/**
+ * Starts a single pass build of the pyramid of n samples. If out of
+ * memory, the pyramid is left empty and feeding it does nothing.
+ */
+void __slope_lod_builder_init (slope_lod_builder_t *builder,
+                               slope_lod_t *lod, int n);
+
+/**
+ * Feeds the samples [start, start+count) in order, start must be a
+ * multiple of the level 0 block size, and so must count except for
+ * the last samples. The result is the same as __slope_lod_build().
+ */
+void __slope_lod_builder_feed (slope_lod_builder_t *builder,
+                               const double *vy, int start, int count);
+
+/**
+ * Number of samples covered by a block of the given level.
+ */
+#define __slope_lod_block_size(level) (1 << (SLOPE_LOD_SHIFT + (level)))
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_LOD_P_H */
@@ -19,6 +19,7 @@
 
 #include "slope/metrics_p.h"
 #include "slope/item_p.h"
+#include "slope/figure_p.h"
 #include "slope/list.h"
 #include <cairo.h>
 #include <stdlib.h>
@@ -54,6 +55,7 @@ void slope_metrics_set_visible (slope_metrics_t *metrics,
 {
     if (metrics == NULL) return;
     metrics->visible = visible;
+    __slope_figure_touch(metrics->figure);
 }
 
 
@@ -61,7 +63,13 @@ void slope_metrics_update (slope_metrics_t *metrics)
 {
     if (metrics == NULL) return;
     if (metrics->klass->update_fn) {
+        slope_figure_t *figure = metrics->figure;
+        double start = __slope_figure_stats_begin(figure);
         (*metrics->klass->update_fn)(metrics);
+        /* accounted to the next draw */
+        if (__slope_figure_stats_on(figure)) {
+            figure->stats_update += __slope_figure_stats_clock() - start;
+        }
     }
 }
 
@@ -83,7 +91,7 @@ void slope_metrics_add_item (slope_metrics_t *metrics,
     metrics->item_list = slope_list_append(
         metrics->item_list, item);
     slope_metrics_update(metrics);
-    slope_figure_notify_appearence_change(metrics->figure);
+    slope_figure_notify_appearence_change(metrics->figure, NULL);
 }
 
 
@@ -106,7 +114,7 @@ void slope_metrics_remove_item (slope_metrics_t *metrics,
     }
     if (change) {
         slope_metrics_update(metrics);
-        slope_figure_notify_appearence_change(metrics->figure);
+        slope_figure_notify_appearence_change(metrics->figure, NULL);
     }
 }
 
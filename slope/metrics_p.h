@@ -54,6 +54,9 @@ struct _slope_metrics
     double width_figure, height_figure;
     /* show this metric's items? */
     int visible;
+    /* changes when a draw uses another data to figure transform
+       than the previous one, so item layers know they are stale */
+    int revision;
 };
 
 
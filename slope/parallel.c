@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/parallel_p.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+
+typedef struct _slope_parallel_job
+{
+    slope_task_t task;
+    void *data;
+    int index;
+}
+slope_parallel_job_t;
+
+
+typedef struct _slope_parallel_queue
+{
+    slope_task_t task;
+    void *data;
+    int ntasks;
+    int next;
+#if !defined(_WIN32)
+    pthread_mutex_t lock;
+#endif
+}
+slope_parallel_queue_t;
+
+
+int __slope_parallel_ncpu ()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int) info.dwNumberOfProcessors;
+#else
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    return ncpu < 1 ? 1 : (int) ncpu;
+#endif
+}
+
+
+#if !defined(_WIN32)
+static void* __slope_parallel_thread (void *arg)
+{
+    slope_parallel_job_t *job = (slope_parallel_job_t*) arg;
+    (*job->task)(job->data, job->index);
+    return NULL;
+}
+#endif
+
+
+void __slope_parallel_for (slope_task_t task, void *data, int ntasks)
+{
+    int k;
+#if defined(_WIN32)
+    for (k=0; k<ntasks; k++) {
+        (*task)(data, k);
+    }
+#else
+    if (ntasks < 1) return;
+
+    pthread_t *threads = malloc(ntasks*sizeof(pthread_t));
+    slope_parallel_job_t *jobs = malloc(ntasks*sizeof(slope_parallel_job_t));
+    int *started = malloc(ntasks*sizeof(int));
+    if (threads == NULL || jobs == NULL || started == NULL) {
+        /* no memory to track threads, run everything here */
+        free(started);
+        free(jobs);
+        free(threads);
+        for (k=0; k<ntasks; k++) {
+            (*task)(data, k);
+        }
+        return;
+    }
+
+    for (k=1; k<ntasks; k++) {
+        jobs[k].task = task;
+        jobs[k].data = data;
+        jobs[k].index = k;
+        started[k] = pthread_create(
+            &threads[k], NULL, __slope_parallel_thread, &jobs[k]) == 0;
+    }
+    (*task)(data, 0);
+    for (k=1; k<ntasks; k++) {
+        if (started[k]) {
+            pthread_join(threads[k], NULL);
+        }
+        else {
+            (*task)(data, k);
+        }
+    }
+
+    free(started);
+    free(jobs);
+    free(threads);
+#endif
+}
+
+#if !defined(_WIN32)
+static void __slope_parallel_worker (void *data, int index)
+{
+    slope_parallel_queue_t *queue = (slope_parallel_queue_t*) data;
+    (void) index;
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int k = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (k >= queue->ntasks) return;
+        (*queue->task)(queue->data, k);
+    }
+}
+#endif
+
+
+void __slope_parallel_queue (slope_task_t task, void *data,
+                             int ntasks, int nworkers)
+{
+#if defined(_WIN32)
+    int k;
+    (void) nworkers;
+    for (k=0; k<ntasks; k++) {
+        (*task)(data, k);
+    }
+#else
+    slope_parallel_queue_t queue;
+    if (nworkers > ntasks) nworkers = ntasks;
+    if (nworkers < 1) return;
+
+    queue.task = task;
+    queue.data = data;
+    queue.ntasks = ntasks;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+    __slope_parallel_for(__slope_parallel_worker, &queue, nworkers);
+    pthread_mutex_destroy(&queue.lock);
+#endif
+}
+
+/* slope/parallel.c */
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_PARALLEL_P_H
+#define SLOPE_PARALLEL_P_H
+
+#include "slope/global.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ */
+typedef void (*slope_task_t) (void *data, int index);
+
+/**
+ * Number of processors available to run tasks.
+ */
+int __slope_parallel_ncpu ();
+
+/**
+ * Runs task(data, k) for k in [0, ntasks), each on its own thread
+ * with the calling thread taking index 0, and returns when all of
+ * them are done. Runs them one after the other on platforms without
+ * threads or if a thread can't be created.
+ */
+void __slope_parallel_for (slope_task_t task, void *data, int ntasks);
+
+/**
+ * Runs task(data, k) for k in [0, ntasks) on at most nworkers threads,
+ * each worker taking the next pending index when it is done with the
+ * last one. Suits tasks of uneven cost.
+ */
+void __slope_parallel_queue (slope_task_t task, void *data,
+                             int ntasks, int nworkers);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_PARALLEL_P_H */
@@ -19,6 +19,13 @@
 
 #include "slope/primitives.h"
 #include <cairo.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+/* labels switch to engineering notation from these on */
+#define SLOPE_LABEL_MAX_FIXED     1e7
+#define SLOPE_LABEL_MAX_DECIMALS  6
 
 
 void slope_rect_set (slope_rect_t *rect, double x,
@@ -106,4 +113,152 @@ void slope_cairo_rectangle(cairo_t *cr,
                     rect->width, rect->height);
 }
 
+/**
+ * Writes the unsigned integer n backwards ending at end, at least
+ * ndigits long, returning where it starts.
+ */
+static char* __slope_label_digits (char *end, unsigned long long n,
+                                   int ndigits)
+{
+    do {
+        *--end = (char) ('0' + n%10);
+        n /= 10;
+        --ndigits;
+    } while (n > 0 || ndigits > 0);
+    return end;
+}
+
+
+/**
+ * Writes |value| with the given number of decimals, which must leave
+ * less than 10^18 in the digits, and returns its length.
+ */
+static int __slope_label_fixed (char *out, double value, int decimals,
+                                int *is_zero)
+{
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    double scale = pow(10.0, decimals);
+    unsigned long long n = (unsigned long long) floor(fabs(value)*scale + 0.5);
+    unsigned long long unit = (unsigned long long) scale;
+    int len = 0;
+
+    *is_zero = n == 0;
+    char *p = __slope_label_digits(end, n/unit, 1);
+    memcpy(out, p, end - p);
+    len += (int) (end - p);
+    if (decimals > 0) {
+        out[len++] = '.';
+        p = __slope_label_digits(end, n%unit, decimals);
+        memcpy(out + len, p, end - p);
+        len += (int) (end - p);
+    }
+    return len;
+}
+
+
+static int __slope_label_clamp (int decimals)
+{
+    if (decimals < 0) return 0;
+    if (decimals > 15) return 15;
+    return decimals;
+}
+
+
+int slope_label_format (char *label, int size,
+                        double value, double step)
+{
+    char text[48];
+    int len = 0;
+    int trim = SLOPE_FALSE;
+    int is_zero;
+
+    if (label == NULL || size < 1) return 0;
+
+    if (isnan(value)) {
+        memcpy(text, "nan", 3);
+        len = 3;
+    }
+    else if (isinf(value)) {
+        if (value < 0.0) text[len++] = '-';
+        memcpy(text + len, "inf", 3);
+        len += 3;
+    }
+    else if (value == 0.0 && (!(step > 0.0) || !isfinite(step))) {
+        text[len++] = '0';
+    }
+    else {
+        const double magnitude = fabs(value);
+        /* without a step keep six significant digits */
+        if (!(step > 0.0) || !isfinite(step)) {
+            step = pow(10.0, floor(log10(magnitude)) - 5.0);
+            trim = SLOPE_TRUE;
+        }
+
+        /* fewest decimals that write the step exactly, negative for
+           steps that are multiples of ten */
+        int step_decimals = (int) -floor(log10(step));
+        while (step_decimals < 15) {
+            double scaled = step*pow(10.0, step_decimals);
+            if (fabs(scaled - floor(scaled + 0.5)) <= 1e-6*scaled) break;
+            ++step_decimals;
+        }
+
+        char *mantissa = text + 1;
+        int exponent = 0;
+        int decimals = step_decimals < 0 ? 0 : step_decimals;
+        if (magnitude == 0.0) {
+            /* zero keeps the decimals of its neighbours, unless they
+               are in engineering notation */
+            if (decimals > SLOPE_LABEL_MAX_DECIMALS) decimals = 0;
+            len = __slope_label_fixed(mantissa, 0.0, decimals, &is_zero);
+        }
+        else if (magnitude >= SLOPE_LABEL_MAX_FIXED
+                || decimals > SLOPE_LABEL_MAX_DECIMALS) {
+            exponent = 3*(int) floor(log10(magnitude)/3.0);
+            decimals = __slope_label_clamp(step_decimals + exponent);
+            /* rounding may carry the mantissa up to 1000 */
+            if (floor(magnitude/pow(10.0, exponent - decimals) + 0.5)
+                    >= pow(10.0, decimals + 3)) {
+                exponent += 3;
+                decimals = __slope_label_clamp(step_decimals + exponent);
+            }
+            len = __slope_label_fixed(mantissa,
+                                      magnitude/pow(10.0, exponent),
+                                      decimals, &is_zero);
+        }
+        else {
+            len = __slope_label_fixed(mantissa, magnitude, decimals, &is_zero);
+        }
+
+        if (trim && decimals > 0) {
+            while (mantissa[len-1] == '0') --len;
+            if (mantissa[len-1] == '.') --len;
+        }
+        if (exponent != 0) {
+            char *end = mantissa + len + 8;
+            char *p;
+            mantissa[len++] = 'e';
+            if (exponent < 0) mantissa[len++] = '-';
+            p = __slope_label_digits(end, (unsigned) abs(exponent), 1);
+            memmove(mantissa + len, p, end - p);
+            len += (int) (end - p);
+        }
+
+        /* no sign on values that round to zero */
+        if (value < 0.0 && is_zero == SLOPE_FALSE) {
+            text[0] = '-';
+            len += 1;
+        }
+        else {
+            memmove(text, mantissa, len);
+        }
+    }
+
+    if (len > size - 1) len = size - 1;
+    memcpy(label, text, len);
+    label[len] = '\0';
+    return len;
+}
+
 /* slope/primitives.c */
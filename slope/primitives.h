@@ -201,6 +201,20 @@ slope_public void
 slope_cairo_rectangle(cairo_t *cr,
                       const slope_rect_t *rect);
 
+
+/**
+ * Formats value as an axis label, with as many decimals as step, the
+ * spacing between labels, needs. Very large values and very small
+ * steps get engineering notation, like 12.5e6. Uses a '.' whatever
+ * the locale and doesn't allocate. With step <= 0, six significant
+ * digits are kept.
+ *
+ * @return The length of the label, truncated to fit in size bytes.
+ */
+slope_public int
+slope_label_format (char *label, int size,
+                    double value, double step);
+
 SLOPE_END_DECLS
 
 #endif /*SLOPE_PRIMITIVES_H */
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/range_p.h"
+#include "slope/parallel_p.h"
+#include "slope/dataview_p.h"
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#define SLOPE_RANGE_MAX_TASKS 16
+#define SLOPE_RANGE_CHUNK 1024
+
+
+typedef struct _slope_range_job
+{
+    const double *vx, *vy;
+    const slope_dataview_t *xview, *yview;
+    int n, ntasks;
+    slope_range_t *ranges;
+}
+slope_range_job_t;
+
+
+static void __slope_range_task (void *data, int index)
+{
+    slope_range_job_t *job = (slope_range_job_t*) data;
+    int begin = (int) ((long) job->n*index/job->ntasks);
+    int end = (int) ((long) job->n*(index+1)/job->ntasks);
+    if (job->xview) {
+        __slope_range_scan_view_slice(&job->ranges[index], job->xview,
+                                      job->yview, begin, end);
+        return;
+    }
+    __slope_range_scan_slice(&job->ranges[index],
+                             job->vx+begin, job->vy+begin, end-begin);
+}
+
+
+static int __slope_range_ntasks (int n)
+{
+    int ntasks = 1;
+    if (n >= SLOPE_RANGE_PARALLEL_MIN) {
+        ntasks = __slope_parallel_ncpu();
+        if (ntasks > n/(SLOPE_RANGE_PARALLEL_MIN/4))
+            ntasks = n/(SLOPE_RANGE_PARALLEL_MIN/4);
+        if (ntasks > SLOPE_RANGE_MAX_TASKS)
+            ntasks = SLOPE_RANGE_MAX_TASKS;
+    }
+    return ntasks;
+}
+
+
+static void __slope_range_run (slope_range_t *range, slope_range_job_t *job)
+{
+    slope_range_t ranges[SLOPE_RANGE_MAX_TASKS];
+    int k;
+    job->ranges = ranges;
+    __slope_parallel_for(__slope_range_task, job, job->ntasks);
+    *range = ranges[0];
+    for (k=1; k<job->ntasks; k++) {
+        __slope_range_merge(range, &ranges[k]);
+    }
+}
+
+
+void __slope_range_scan (slope_range_t *range,
+                         const double *vx, const double *vy, int n)
+{
+    const int ntasks = __slope_range_ntasks(n);
+    if (ntasks <= 1) {
+        __slope_range_scan_slice(range, vx, vy, n);
+        return;
+    }
+    slope_range_job_t job;
+    job.vx = vx;
+    job.vy = vy;
+    job.xview = job.yview = NULL;
+    job.n = n;
+    job.ntasks = ntasks;
+    __slope_range_run(range, &job);
+}
+
+
+void __slope_range_scan_views (slope_range_t *range,
+                               const slope_dataview_t *xview,
+                               const slope_dataview_t *yview, int n)
+{
+    const int ntasks = __slope_range_ntasks(n);
+    if (ntasks <= 1) {
+        __slope_range_scan_view_slice(range, xview, yview, 0, n);
+        return;
+    }
+    slope_range_job_t job;
+    job.vx = job.vy = NULL;
+    job.xview = xview;
+    job.yview = yview;
+    job.n = n;
+    job.ntasks = ntasks;
+    __slope_range_run(range, &job);
+}
+
+
+void __slope_range_scan_view_slice (slope_range_t *range,
+                                    const slope_dataview_t *xview,
+                                    const slope_dataview_t *yview,
+                                    int begin, int end)
+{
+    /* values are converted a cache sized chunk at a time, merging
+       the chunks also checks x ordering across them */
+    double x[SLOPE_RANGE_CHUNK], y[SLOPE_RANGE_CHUNK];
+    slope_range_t part;
+    int start;
+
+    __slope_range_scan_slice(range, NULL, NULL, 0);
+    for (start=begin; start<end; start+=SLOPE_RANGE_CHUNK) {
+        int count = end - start;
+        if (count > SLOPE_RANGE_CHUNK) count = SLOPE_RANGE_CHUNK;
+        __slope_dataview_fetch(xview, start, count, x);
+        __slope_dataview_fetch(yview, start, count, y);
+        __slope_range_scan_slice(&part, x, y, count);
+        if (start == begin) *range = part;
+        else __slope_range_merge(range, &part);
+    }
+}
+
+
+void __slope_range_scan_slice (slope_range_t *range,
+                               const double *vx, const double *vy, int n)
+{
+    double xmin = HUGE_VAL, xmax = -HUGE_VAL;
+    double ymin = HUGE_VAL, ymax = -HUGE_VAL;
+    int sorted = 1;
+    int k = 1;
+
+    range->x_sorted = 1;
+    range->has_finite = 0;
+    range->first_x = range->last_x = 0.0;
+    range->xmin = range->xmax = 0.0;
+    range->ymin = range->ymax = 0.0;
+    if (n < 1) return;
+    range->first_x = vx[0];
+    range->last_x = vx[n-1];
+
+    if (isfinite(vx[0]) && isfinite(vy[0])) {
+        xmin = xmax = vx[0];
+        ymin = ymax = vy[0];
+    }
+
+#if defined(__SSE2__)
+    /* non finite values fail |v| <= DBL_MAX and are replaced by
+       +inf in the min and -inf in the max, so they never win */
+    const __m128d absmask = _mm_castsi128_pd(
+        _mm_set1_epi64x(0x7fffffffffffffffLL));
+    const __m128d dblmax = _mm_set1_pd(DBL_MAX);
+    const __m128d pinf = _mm_set1_pd(HUGE_VAL);
+    const __m128d ninf = _mm_set1_pd(-HUGE_VAL);
+    __m128d vxmin = pinf, vxmax = ninf;
+    __m128d vymin = pinf, vymax = ninf;
+    __m128d vsorted = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    double tmp[2];
+
+    for ( ; k+2 <= n; k += 2) {
+        __m128d x = _mm_loadu_pd(vx+k);
+        __m128d y = _mm_loadu_pd(vy+k);
+        __m128d xprev = _mm_loadu_pd(vx+k-1);
+        __m128d fin = _mm_and_pd(
+            _mm_cmple_pd(_mm_and_pd(x, absmask), dblmax),
+            _mm_cmple_pd(_mm_and_pd(y, absmask), dblmax));
+        vxmin = _mm_min_pd(vxmin, _mm_or_pd(_mm_and_pd(fin, x),
+                                            _mm_andnot_pd(fin, pinf)));
+        vxmax = _mm_max_pd(vxmax, _mm_or_pd(_mm_and_pd(fin, x),
+                                            _mm_andnot_pd(fin, ninf)));
+        vymin = _mm_min_pd(vymin, _mm_or_pd(_mm_and_pd(fin, y),
+                                            _mm_andnot_pd(fin, pinf)));
+        vymax = _mm_max_pd(vymax, _mm_or_pd(_mm_and_pd(fin, y),
+                                            _mm_andnot_pd(fin, ninf)));
+        vsorted = _mm_and_pd(vsorted, _mm_cmpge_pd(x, xprev));
+    }
+    sorted = _mm_movemask_pd(vsorted) == 3;
+    _mm_storeu_pd(tmp, vxmin);
+    xmin = fmin(xmin, fmin(tmp[0], tmp[1]));
+    _mm_storeu_pd(tmp, vxmax);
+    xmax = fmax(xmax, fmax(tmp[0], tmp[1]));
+    _mm_storeu_pd(tmp, vymin);
+    ymin = fmin(ymin, fmin(tmp[0], tmp[1]));
+    _mm_storeu_pd(tmp, vymax);
+    ymax = fmax(ymax, fmax(tmp[0], tmp[1]));
+#endif
+
+    for ( ; k<n; k++) {
+        if (!(vx[k] >= vx[k-1])) sorted = 0;
+        if (!isfinite(vx[k]) || !isfinite(vy[k])) continue;
+        if (vx[k] < xmin) xmin = vx[k];
+        if (vx[k] > xmax) xmax = vx[k];
+        if (vy[k] < ymin) ymin = vy[k];
+        if (vy[k] > ymax) ymax = vy[k];
+    }
+
+    range->x_sorted = sorted && !isnan(vx[0]);
+    if (xmin <= xmax) {
+        range->has_finite = 1;
+        range->xmin = xmin;
+        range->xmax = xmax;
+        range->ymin = ymin;
+        range->ymax = ymax;
+    }
+}
+
+
+void __slope_range_merge (slope_range_t *range,
+                          const slope_range_t *next)
+{
+    range->x_sorted = range->x_sorted && next->x_sorted
+                      && next->first_x >= range->last_x;
+    range->last_x = next->last_x;
+    if (!next->has_finite) return;
+    if (!range->has_finite) {
+        range->has_finite = 1;
+        range->xmin = next->xmin;
+        range->xmax = next->xmax;
+        range->ymin = next->ymin;
+        range->ymax = next->ymax;
+        return;
+    }
+    if (next->xmin < range->xmin) range->xmin = next->xmin;
+    if (next->xmax > range->xmax) range->xmax = next->xmax;
+    if (next->ymin < range->ymin) range->ymin = next->ymin;
+    if (next->ymax > range->ymax) range->ymax = next->ymax;
+}
+
+/* slope/range.c */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_RANGE_P_H
+#define SLOPE_RANGE_P_H
+
+#include "slope/dataview.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Below this number of points range scans run on a single thread.
+ */
+#define SLOPE_RANGE_PARALLEL_MIN (1 << 20)
+
+/**
+ * Bounds of the finite points of a data set. Points with a NaN or
+ * infinite coordinate are gaps and don't count. x_sorted tells if
+ * the x values are all non-decreasing (a NaN x breaks it).
+ */
+typedef struct _slope_range
+{
+    double xmin, xmax;
+    double ymin, ymax;
+    double first_x, last_x;
+    int    has_finite;
+    int    x_sorted;
+}
+slope_range_t;
+
+/**
+ * Scans n points, using SIMD instructions where available and
+ * spreading big data sets over the available processors.
+ */
+void __slope_range_scan (slope_range_t *range,
+                         const double *vx, const double *vy, int n);
+
+/**
+ * Single threaded scan of a slice of the data.
+ */
+void __slope_range_scan_slice (slope_range_t *range,
+                               const double *vx, const double *vy, int n);
+
+/**
+ * Scans n points read through data views.
+ */
+void __slope_range_scan_views (slope_range_t *range,
+                               const slope_dataview_t *xview,
+                               const slope_dataview_t *yview, int n);
+
+/**
+ */
+void __slope_range_scan_view_slice (slope_range_t *range,
+                                    const slope_dataview_t *xview,
+                                    const slope_dataview_t *yview,
+                                    int begin, int end);
+
+/**
+ * Merges the range of the points that follow those of range.
+ */
+void __slope_range_merge (slope_range_t *range,
+                          const slope_range_t *next);
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_RANGE_P_H */
@@ -58,5 +58,25 @@ slope_item_t* slope_chart_add_plot (slope_figure_t *chart,
     return plot;
 }
 
+slope_item_t* slope_chart_add_plot_file (slope_figure_t *chart,
+                                         const char *path,
+                                         slope_dtype_t type,
+                                         int header, int interleaved,
+                                         const char *title,
+                                         const char *fmt)
+{
+    slope_item_t *plot = slope_xyitem_create_mapped(
+        path, type, header, interleaved, title, fmt);
+    if (plot == NULL) {
+        return NULL;
+    }
+    slope_iterator_t *iter =
+        slope_list_first(slope_figure_get_metrics_list(chart));
+    slope_metrics_t *metrics =
+        (slope_metrics_t*) slope_iterator_data(iter);
+    slope_metrics_add_item(metrics, plot);
+    return plot;
+}
+
 /* slope/slope.h */
 
@@ -52,6 +52,9 @@
 
 /* for figure object */
 #include "slope/figure.h"
+#include "slope/export.h"
+#include "slope/document.h"
+#include "slope/animation.h"
 /* for xy charts */
 #include "slope/xymetrics.h"
 #include "slope/xyitem.h"
@@ -81,4 +84,14 @@ slope_chart_add_plot (slope_figure_t *chart,
                       const double *x, const double *y, int n,
                       const char *title, const char *fmt);
 
+/**
+ * @ingroup Util
+ * @brief Adds a plot of a raw binary file, see
+ * slope_xyitem_create_mapped().
+ */
+slope_public slope_item_t*
+slope_chart_add_plot_file (slope_figure_t *chart, const char *path,
+                           slope_dtype_t type, int header, int interleaved,
+                           const char *title, const char *fmt);
+
 #endif /*SLOPE_H */
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/stream_p.h"
+#include <stdlib.h>
+#include <math.h>
+
+
+#define __slope_stream_deque_at(stream, deque, k) \
+    ((deque)->slot[((deque)->head + (k)) % (stream)->capacity])
+
+
+static void __slope_stream_deque_push (slope_stream_t *stream,
+                                       slope_stream_deque_t *deque,
+                                       const double *values, int slot,
+                                       int greater)
+{
+    /* samples that can no longer be the extreme while this one is
+       in the window leave from the back */
+    while (deque->len > 0) {
+        int back_slot = __slope_stream_deque_at(stream, deque, deque->len-1);
+        double back = values[back_slot];
+        if (greater ? back > values[slot] : back < values[slot]) break;
+        deque->len -= 1;
+    }
+    __slope_stream_deque_at(stream, deque, deque->len) = slot;
+    deque->len += 1;
+}
+
+
+static void __slope_stream_deque_evict (slope_stream_t *stream,
+                                        slope_stream_deque_t *deque,
+                                        int slot)
+{
+    if (deque->len > 0 && deque->slot[deque->head] == slot) {
+        deque->head = (deque->head + 1) % stream->capacity;
+        deque->len -= 1;
+    }
+}
+
+
+slope_stream_t* __slope_stream_create (int capacity)
+{
+    if (capacity < 1) return NULL;
+    slope_stream_t *stream = malloc(sizeof(slope_stream_t));
+    if (stream == NULL) return NULL;
+    stream->vx = malloc(capacity*sizeof(double));
+    stream->vy = malloc(capacity*sizeof(double));
+    stream->xmin.slot = malloc(4*(size_t) capacity*sizeof(int));
+    if (stream->vx == NULL || stream->vy == NULL
+            || stream->xmin.slot == NULL) {
+        __slope_stream_destroy(stream);
+        return NULL;
+    }
+    stream->xmax.slot = stream->xmin.slot + capacity;
+    stream->ymin.slot = stream->xmin.slot + 2*capacity;
+    stream->ymax.slot = stream->xmin.slot + 3*capacity;
+    stream->capacity = capacity;
+    __slope_stream_clear(stream);
+    return stream;
+}
+
+
+void __slope_stream_destroy (slope_stream_t *stream)
+{
+    if (stream == NULL) return;
+    free(stream->xmin.slot);
+    free(stream->vx);
+    free(stream->vy);
+    free(stream);
+}
+
+
+void __slope_stream_clear (slope_stream_t *stream)
+{
+    stream->head = 0;
+    stream->count = 0;
+    stream->descents = 0;
+    stream->xmin.head = stream->xmin.len = 0;
+    stream->xmax.head = stream->xmax.len = 0;
+    stream->ymin.head = stream->ymin.len = 0;
+    stream->ymax.head = stream->ymax.len = 0;
+}
+
+
+void __slope_stream_push (slope_stream_t *stream, double x, double y)
+{
+    const int cap = stream->capacity;
+
+    /* drop the oldest sample if full, its slot takes the new one */
+    if (stream->count == cap) {
+        const int old = stream->head;
+        const int next = old + 1 < cap ? old + 1 : 0;
+        if (cap > 1 && !(stream->vx[next] >= stream->vx[old])) {
+            stream->descents -= 1;
+        }
+        __slope_stream_deque_evict(stream, &stream->xmin, old);
+        __slope_stream_deque_evict(stream, &stream->xmax, old);
+        __slope_stream_deque_evict(stream, &stream->ymin, old);
+        __slope_stream_deque_evict(stream, &stream->ymax, old);
+        stream->head = next;
+        stream->count -= 1;
+    }
+
+    const int slot = __slope_stream_slot(stream, stream->count);
+    if (stream->count > 0) {
+        const int last = slot > 0 ? slot - 1 : cap - 1;
+        if (!(x >= stream->vx[last])) {
+            stream->descents += 1;
+        }
+    }
+    stream->vx[slot] = x;
+    stream->vy[slot] = y;
+    stream->count += 1;
+
+    /* points with a NaN or infinite coordinate are gaps and never
+       take part in the range */
+    if (isfinite(x) && isfinite(y)) {
+        __slope_stream_deque_push(stream, &stream->xmin, stream->vx, slot, 0);
+        __slope_stream_deque_push(stream, &stream->xmax, stream->vx, slot, 1);
+        __slope_stream_deque_push(stream, &stream->ymin, stream->vy, slot, 0);
+        __slope_stream_deque_push(stream, &stream->ymax, stream->vy, slot, 1);
+    }
+}
+
+
+void __slope_stream_get_range (const slope_stream_t *stream,
+                               slope_range_t *range)
+{
+    range->x_sorted = stream->descents == 0;
+    range->has_finite = stream->xmin.len > 0;
+    range->first_x = range->last_x = 0.0;
+    range->xmin = range->xmax = 0.0;
+    range->ymin = range->ymax = 0.0;
+    if (stream->count > 0) {
+        range->first_x = stream->vx[stream->head];
+        range->last_x = stream->vx[__slope_stream_slot(stream, stream->count-1)];
+        if (isnan(range->first_x)) range->x_sorted = 0;
+    }
+    if (range->has_finite) {
+        range->xmin = stream->vx[stream->xmin.slot[stream->xmin.head]];
+        range->xmax = stream->vx[stream->xmax.slot[stream->xmax.head]];
+        range->ymin = stream->vy[stream->ymin.slot[stream->ymin.head]];
+        range->ymax = stream->vy[stream->ymax.slot[stream->ymax.head]];
+    }
+}
+
+/* slope/stream.c */
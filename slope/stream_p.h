@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_STREAM_P_H
+#define SLOPE_STREAM_P_H
+
+#include "slope/range_p.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Slots of the ring buffer, in order of arrival, whose values are
+ * candidates for the extreme of the window. The front is the extreme.
+ */
+typedef struct _slope_stream_deque
+{
+    int *slot;
+    int  head;
+    int  len;
+}
+slope_stream_deque_t;
+
+/**
+ * Fixed capacity ring buffer of samples that, once full, drops the
+ * oldest sample for each one appended. The range of the finite
+ * samples and whether x is sorted are kept up to date in O(1)
+ * amortized time per sample.
+ */
+typedef struct _slope_stream
+{
+    double *vx, *vy;
+    int     capacity;
+    int     head;      /* slot of the oldest sample */
+    int     count;
+    int     descents;  /* neighbour pairs whose x does not increase */
+    slope_stream_deque_t xmin, xmax;
+    slope_stream_deque_t ymin, ymax;
+}
+slope_stream_t;
+
+/**
+ * Returns NULL if capacity is less than 1 or out of memory.
+ */
+slope_stream_t* __slope_stream_create (int capacity);
+
+/**
+ */
+void __slope_stream_destroy (slope_stream_t *stream);
+
+/**
+ */
+void __slope_stream_push (slope_stream_t *stream, double x, double y);
+
+/**
+ */
+void __slope_stream_clear (slope_stream_t *stream);
+
+/**
+ */
+void __slope_stream_get_range (const slope_stream_t *stream,
+                               slope_range_t *range);
+
+/**
+ * Slot of the ring buffer holding the k-th oldest sample.
+ */
+#define __slope_stream_slot(stream, k) \
+    ((stream)->head + (k) < (stream)->capacity \
+     ? (stream)->head + (k) : (stream)->head + (k) - (stream)->capacity)
+
+SLOPE_END_DECLS
+
+#endif /*SLOPE_STREAM_P_H */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/ticks_p.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+void __slope_ticks_init (slope_ticks_t *ticks)
+{
+    ticks->ticks = NULL;
+    ticks->nticks = 0;
+    ticks->nalloc = 0;
+    ticks->step = 0.0;
+    ticks->nminor = 1;
+    ticks->revision = 0;
+    memset(ticks->key, 0, sizeof(ticks->key));
+}
+
+
+void __slope_ticks_destroy (slope_ticks_t *ticks)
+{
+    free(ticks->ticks);
+    ticks->ticks = NULL;
+    ticks->nticks = ticks->nalloc = 0;
+}
+
+
+/**
+ * Value of the tick with the given index, for minor ticks spaced by
+ * mantissa times 10^exponent.
+ */
+static double __slope_ticks_value (double index, int mantissa, int exponent)
+{
+    /* dividing by an exact power of ten rounds once, multiplying
+       by the inexact inverse would round twice */
+    if (exponent < 0) {
+        return index*mantissa / pow(10.0, -exponent);
+    }
+    return index*mantissa * pow(10.0, exponent);
+}
+
+
+int __slope_ticks_update (slope_ticks_t *ticks,
+                          double min, double max,
+                          double origin, double scale,
+                          double length, double spacing)
+{
+    double key[5];
+    key[0] = min;
+    key[1] = max;
+    key[2] = origin;
+    key[3] = scale;
+    key[4] = length;
+    if (ticks->revision > 0
+            && memcmp(key, ticks->key, sizeof(key)) == 0) {
+        return SLOPE_FALSE;
+    }
+    memcpy(ticks->key, key, sizeof(key));
+    ticks->revision += 1;
+    ticks->nticks = 0;
+
+    double span = max - min;
+    if (!(span > 0.0) || !isfinite(span) || !(length > 0.0)) {
+        return SLOPE_TRUE;
+    }
+
+    /* smallest 1, 2 or 5 times 10^exponent step giving majors at
+       least spacing apart */
+    int nmajor = (int) (length/spacing);
+    if (nmajor < 1) nmajor = 1;
+    double raw = span/nmajor;
+    int exponent = (int) floor(log10(raw));
+    double norm = raw / pow(10.0, exponent);
+    int mantissa;
+    if (norm <= 1.0 + 1e-9) mantissa = 1;
+    else if (norm <= 2.0 + 1e-9) mantissa = 2;
+    else if (norm <= 5.0 + 1e-9) mantissa = 5;
+    else {
+        mantissa = 1;
+        exponent += 1;
+    }
+    ticks->step = mantissa * pow(10.0, exponent);
+
+    /* minor ticks at 2, 5 and 1 times 10^(exponent-1) respectively */
+    int minor_mantissa, minor_exponent = exponent - 1;
+    switch (mantissa) {
+        case 1:
+            ticks->nminor = 5;
+            minor_mantissa = 2;
+            break;
+        case 2:
+            ticks->nminor = 4;
+            minor_mantissa = 5;
+            break;
+        default:
+            ticks->nminor = 5;
+            minor_mantissa = 1;
+            minor_exponent = exponent;
+            break;
+    }
+    double minor_step = minor_mantissa * pow(10.0, minor_exponent);
+    double first = ceil(min/minor_step - 1e-9);
+    double last = floor(max/minor_step + 1e-9);
+    if (!(last - first < SLOPE_TICKS_MAX)) {
+        return SLOPE_TRUE;
+    }
+
+    int n = (int) (last - first) + 1;
+    if (n > ticks->nalloc) {
+        slope_tick_t *array = realloc(ticks->ticks, n*sizeof(slope_tick_t));
+        if (array == NULL) return SLOPE_TRUE;
+        ticks->ticks = array;
+        ticks->nalloc = n;
+    }
+    int k;
+    for (k=0; k<n; k++) {
+        slope_tick_t *tick = &ticks->ticks[k];
+        double index = first + k;
+        tick->value = __slope_ticks_value(index, minor_mantissa,
+                                          minor_exponent);
+        tick->pos = origin + (tick->value - min)*scale;
+        tick->major = fmod(index, ticks->nminor) == 0.0;
+        if (tick->major) {
+            slope_label_format(tick->label, sizeof(tick->label),
+                               tick->value, ticks->step);
+        }
+        else {
+            tick->label[0] = '\0';
+        }
+    }
+    ticks->nticks = n;
+    return SLOPE_TRUE;
+}
+
+/* slope/ticks.c */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOPE_TICKS_P_H
+#define SLOPE_TICKS_P_H
+
+#include "slope/primitives.h"
+
+SLOPE_BEGIN_DECLS
+
+/**
+ * Above this number of ticks a table is left empty.
+ */
+#define SLOPE_TICKS_MAX 100000
+
+/**
+ * A tick at value, drawn at pos in figure coordinates. Major ticks
+ * carry their label.
+ */
+typedef struct _slope_tick
+{
+    double value;
+    double pos;
+    int major;
+    char label[32];
+}
+slope_tick_t;
+
+/**
+ * Ticks of a data range, majors spaced by a 1, 2 or 5 times 10^k
+ * step and subdivided in nminor intervals. Each value is computed
+ * from its integer index, so no error accumulates along the axis.
+ * The table is shared by the two axes of each direction, revision
+ * tells them when to lay out their labels again.
+ */
+typedef struct _slope_ticks
+{
+    slope_tick_t *ticks;
+    int nticks;
+    int nalloc;
+    double step;
+    int nminor;
+    int revision;
+    double key[5];
+}
+slope_ticks_t;
+
+/**
+ */
+void __slope_ticks_init (slope_ticks_t *ticks);
+
+/**
+ */
+void __slope_ticks_destroy (slope_ticks_t *ticks);
+
+/**
+ * Rebuilds the table for the range [min,max] drawn over length
+ * figure units, with a position of origin + (value - min)*scale and
+ * majors at least spacing units apart. Returns SLOPE_FALSE, leaving
+ * the table untouched, if it was already built for these arguments.
+ */
+int __slope_ticks_update (slope_ticks_t *ticks,
+                          double min, double max,
+                          double origin, double scale,
+                          double length, double spacing);
+
+SLOPE_END_DECLS
+
+#endif /* SLOPE_TICKS_P_H */
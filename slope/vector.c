@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015  Elvis Teixeira
+ *
+ * This source code is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This source code is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slope/vector.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define SLOPE_VECTOR_MIN_ALLOC 16
+
+
+static double* __slope_vector_alloc (int nalloc)
+{
+    void *mem = NULL;
+#if defined(_WIN32)
+    mem = _aligned_malloc(nalloc*sizeof(double), SLOPE_VECTOR_ALIGN);
+#else
+    if (posix_memalign(&mem, SLOPE_VECTOR_ALIGN, nalloc*sizeof(double)) != 0) {
+        mem = NULL;
+    }
+#endif
+    return (double*) mem;
+}
+
+
+static void __slope_vector_free (double *v)
+{
+#if defined(_WIN32)
+    _aligned_free(v);
+#else
+    free(v);
+#endif
+}
+
+
+static int __slope_vector_realloc (slope_vector_t *vector, int nalloc)
+{
+    /* aligned blocks can't be realloc'ed, so move the values over */
+    double *v = __slope_vector_alloc(nalloc);
+    if (v == NULL) return SLOPE_ERROR;
+    if (vector->size > 0) {
+        memcpy(v, vector->v, vector->size*sizeof(double));
+    }
+    __slope_vector_free(vector->v);
+    vector->v = v;
+    vector->nalloc = nalloc;
+    return SLOPE_SUCCESS;
+}
+
+
+static int __slope_vector_grow (slope_vector_t *vector, int n)
+{
+    if (n > INT_MAX - vector->size) return SLOPE_ERROR;
+    const int needed = vector->size + n;
+    if (needed <= vector->nalloc) return SLOPE_SUCCESS;
+    /* doubling stops at the largest size an int can count */
+    int nalloc = vector->nalloc > INT_MAX/2 ? INT_MAX : vector->nalloc*2;
+    if (nalloc < needed) nalloc = needed;
+    if (nalloc < SLOPE_VECTOR_MIN_ALLOC) nalloc = SLOPE_VECTOR_MIN_ALLOC;
+    return __slope_vector_realloc(vector, nalloc);
+}
+
+
+slope_vector_t* slope_vector_create (int size)
+{
+    slope_vector_t *vector = malloc(sizeof(slope_vector_t));
+    if (vector == NULL) return NULL;
+    vector->v = NULL;
+    vector->nalloc = 0;
+    vector->size = 0;
+    vector->dirty_from = -1;
+    if (size > 0 && __slope_vector_realloc(vector, size) != SLOPE_SUCCESS) {
+        free(vector);
+        return NULL;
+    }
+    return vector;
+}
+
+
+void slope_vector_destroy (slope_vector_t *vector)
+{
+    if (vector == NULL) return;
+    __slope_vector_free(vector->v);
+    free(vector);
+}
+
+
+int slope_vector_append (slope_vector_t *vector, double value)
+{
+    return slope_vector_append_n(vector, &value, 1);
+}
+
+
+int slope_vector_append_n (slope_vector_t *vector,
+                           const double *values, int n)
+{
+    if (vector == NULL || n < 0) return SLOPE_ERROR;
+    if (n == 0) return SLOPE_SUCCESS;
+    if (__slope_vector_grow(vector, n) != SLOPE_SUCCESS) {
+        return SLOPE_ERROR;
+    }
+    memcpy(vector->v + vector->size, values, (size_t) n*sizeof(double));
+    slope_vector_touch(vector, vector->size);
+    vector->size += n;
+    return SLOPE_SUCCESS;
+}
+
+
+int slope_vector_reserve (slope_vector_t *vector, int nalloc)
+{
+    if (vector == NULL) return SLOPE_ERROR;
+    if (nalloc <= vector->nalloc) return SLOPE_SUCCESS;
+    return __slope_vector_realloc(vector, nalloc);
+}
+
+
+void slope_vector_shrink (slope_vector_t *vector)
+{
+    if (vector == NULL || vector->nalloc == vector->size) return;
+    if (vector->size == 0) {
+        __slope_vector_free(vector->v);
+        vector->v = NULL;
+        vector->nalloc = 0;
+        return;
+    }
+    __slope_vector_realloc(vector, vector->size);
+}
+
+
+void slope_vector_clear (slope_vector_t *vector)
+{
+    if (vector == NULL) return;
+    vector->size = 0;
+    vector->dirty_from = 0;
+}
+
+
+void slope_vector_set (slope_vector_t *vector, int k, double value)
+{
+    if (vector == NULL || k < 0 || k >= vector->size) return;
+    vector->v[k] = value;
+    slope_vector_touch(vector, k);
+}
+
+
+void slope_vector_touch (slope_vector_t *vector, int k)
+{
+    if (vector == NULL) return;
+    if (k < 0) k = 0;
+    if (vector->dirty_from < 0 || k < vector->dirty_from) {
+        vector->dirty_from = k;
+    }
+}
+
+
+int slope_vector_get_size (const slope_vector_t *vector)
+{
+    if (vector == NULL) return 0;
+    return vector->size;
+}
+
+
+const double* slope_vector_get_data (const slope_vector_t *vector)
+{
+    if (vector == NULL) return NULL;
+    return vector->v;
+}
+
+/* slope/vector.c */
@@ -20,26 +20,90 @@
 #ifndef SLOPE_VECTOR_H
 #define SLOPE_VECTOR_H
 
-#include "slope/global.h"
+#include "slope/primitives.h"
 
 SLOPE_BEGIN_DECLS
 
 /**
+ * Byte alignment of a vector's storage, enough for any SIMD load.
+ */
+#define SLOPE_VECTOR_ALIGN 64
+
+/**
+ * A growable array of doubles. The library reads the fields directly,
+ * but they must only be changed through the functions below, so
+ * items built on a vector can tell what changed since they last
+ * looked at it.
  */
 typedef struct _slope_vector
 {
     double *v;
     int nalloc;
     int size;
+    int dirty_from; /* first value changed or appended, or -1 */
 }
 slope_vector_t;
 
 
+/**
+ * @brief Creates an empty vector with room for size values.
+ * @return The vector or NULL if out of memory.
+ */
 slope_public slope_vector_t* slope_vector_create (int size);
 
+/**
+ */
 slope_public void slope_vector_destroy (slope_vector_t *vector);
 
-slope_public void slope_vector_append (slope_vector_t *vector, double value);
+/**
+ * @brief Appends a value, growing the storage geometrically so
+ * n appends cost O(n) in total.
+ * @return SLOPE_SUCCESS or SLOPE_ERROR if out of memory, in which
+ * case the vector is left unchanged.
+ */
+slope_public int slope_vector_append (slope_vector_t *vector, double value);
+
+/**
+ * @brief Appends n values with a single copy.
+ * @return SLOPE_SUCCESS or SLOPE_ERROR if out of memory.
+ */
+slope_public int slope_vector_append_n (slope_vector_t *vector,
+                                        const double *values, int n);
+
+/**
+ * @brief Makes room for at least nalloc values.
+ * @return SLOPE_SUCCESS or SLOPE_ERROR if out of memory.
+ */
+slope_public int slope_vector_reserve (slope_vector_t *vector, int nalloc);
+
+/**
+ * @brief Releases the storage not used by the current values.
+ */
+slope_public void slope_vector_shrink (slope_vector_t *vector);
+
+/**
+ * @brief Removes every value, keeping the storage.
+ */
+slope_public void slope_vector_clear (slope_vector_t *vector);
+
+/**
+ * @brief Changes the value at index k.
+ */
+slope_public void slope_vector_set (slope_vector_t *vector, int k, double value);
+
+/**
+ * @brief Tells the vector that values from index k on were changed
+ * through the v pointer.
+ */
+slope_public void slope_vector_touch (slope_vector_t *vector, int k);
+
+/**
+ */
+slope_public int slope_vector_get_size (const slope_vector_t *vector);
+
+/**
+ */
+slope_public const double* slope_vector_get_data (const slope_vector_t *vector);
 
 SLOPE_END_DECLS
 
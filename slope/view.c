@@ -18,6 +18,8 @@
  */
 
 #include "slope/view.h"
+#include "slope/figure_p.h"
+#include <math.h>
 
 
 #define SLOPE_VIEW_PRIVATE(obj)          \
@@ -49,6 +51,18 @@ static gboolean
 on_button_release_event (GtkWidget *widget, GdkEventButton *event, gpointer *data);
 
 
+/**
+ */
+static void
+slope_view_finalize (GObject *object);
+
+
+/**
+ */
+static void
+queue_draw_selection (GtkWidget *widget);
+
+
 /**
 */
 typedef struct _SlopeViewPrivate SlopeViewPrivate;
@@ -60,6 +74,9 @@ struct _SlopeViewPrivate
 {
     slope_figure_t *figure;
     cairo_surface_t *back_surf;
+    int back_width;
+    int back_height;
+    int back_revision;
     slope_point_t move_start;
     slope_point_t move_end;
     slope_color_t mouse_rec_color;
@@ -73,16 +90,34 @@ G_DEFINE_TYPE(SlopeView, slope_view, GTK_TYPE_DRAWING_AREA);
 static void
 slope_view_class_init(SlopeViewClass *klass)
 {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = slope_view_finalize;
     g_type_class_add_private(klass, sizeof(SlopeViewPrivate));
 }
 
 
+static void
+slope_view_finalize (GObject *object)
+{
+    SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE (object);
+    if (priv->back_surf) {
+        cairo_surface_destroy(priv->back_surf);
+        priv->back_surf = NULL;
+    }
+    G_OBJECT_CLASS(slope_view_parent_class)->finalize(object);
+}
+
+
 static void
 slope_view_init(SlopeView *view)
 {
     SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE (view);
     GtkWidget *widget = GTK_WIDGET (view);
 
+    priv->back_surf = NULL;
+    priv->back_width = 0;
+    priv->back_height = 0;
+    priv->back_revision = 0;
     priv->on_move = SLOPE_FALSE;
     slope_color_set_name(&priv->mouse_rec_color, SLOPE_BLACK);
 
@@ -128,17 +163,36 @@ on_draw_event (GtkWidget *widget, cairo_t *cr, gpointer *data)
 {
     SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE (widget);
     int width, height;
-    slope_rect_t rect;
     width = gtk_widget_get_allocated_width(widget);
     height = gtk_widget_get_allocated_height(widget);
-
-    /* TODO: save figure in back_surf instead of recalculate
-     * everithing for each zooming redraw
-     */
-    slope_rect_set(&rect, 0.0, 0.0, (double)width, (double)height);
     slope_figure_t *figure = priv->figure;
-    slope_figure_draw(figure, cr, &rect);
-        
+
+    /* the figure is rendered only when it or the widget size changed,
+       selection feedback is painted over the cached back surface */
+    if (priv->back_surf == NULL
+            || priv->back_width != width
+            || priv->back_height != height
+            || priv->back_revision != figure->revision) {
+        if (priv->back_surf) {
+            cairo_surface_destroy(priv->back_surf);
+        }
+        priv->back_surf = gdk_window_create_similar_surface(
+            gtk_widget_get_window(widget), CAIRO_CONTENT_COLOR_ALPHA,
+            width, height);
+        priv->back_width = width;
+        priv->back_height = height;
+
+        slope_rect_t rect;
+        slope_rect_set(&rect, 0.0, 0.0, (double)width, (double)height);
+        cairo_t *back_cr = cairo_create(priv->back_surf);
+        slope_figure_draw(figure, back_cr, &rect);
+        cairo_destroy(back_cr);
+        /* drawing may itself touch the figure, e.g. on a metrics update */
+        priv->back_revision = figure->revision;
+    }
+    cairo_set_source_surface(cr, priv->back_surf, 0.0, 0.0);
+    cairo_paint(cr);
+
     if (priv->on_move) {
         slope_cairo_set_color(cr, &priv->mouse_rec_color);
         cairo_set_line_width(cr, 1.0);
@@ -180,9 +234,10 @@ static gboolean on_button_move_event (GtkWidget *widget,
     SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE(widget);
     
     if (priv->on_move) {
+        queue_draw_selection(widget);
         priv->move_end.x = event->x;
         priv->move_end.y = event->y;
-        gtk_widget_queue_draw(widget);
+        queue_draw_selection(widget);
     }
     return TRUE;
 }
@@ -197,6 +252,8 @@ static gboolean on_button_release_event (GtkWidget *widget,
         priv->on_move = SLOPE_FALSE;
         priv->move_end.x = event->x;
         priv->move_end.y = event->y;
+        /* erase the selection rectangle, even if nothing is tracked */
+        queue_draw_selection(widget);
         
         /* if the region is too small, the user probably just
            clicked on a point, no region to track */
@@ -218,4 +275,31 @@ static gboolean on_button_release_event (GtkWidget *widget,
     return TRUE;
 }
 
+
+static void queue_draw_selection (GtkWidget *widget)
+{
+    SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE(widget);
+    int x1 = (int) floor(fmin(priv->move_start.x, priv->move_end.x));
+    int y1 = (int) floor(fmin(priv->move_start.y, priv->move_end.y));
+    int x2 = (int) ceil(fmax(priv->move_start.x, priv->move_end.x));
+    int y2 = (int) ceil(fmax(priv->move_start.y, priv->move_end.y));
+    /* leave room for the dashed line on both sides of the edges */
+    gtk_widget_queue_draw_area(widget, x1 - 2, y1 - 2,
+                               x2 - x1 + 4, y2 - y1 + 4);
+}
+
+
+void slope_view_redraw (GtkWidget *view)
+{
+    if (view == NULL) return;
+    SlopeViewPrivate *priv = SLOPE_VIEW_PRIVATE(view);
+    /* the item layers hold the old data as well */
+    __slope_figure_invalidate_layers(priv->figure);
+    if (priv->back_surf) {
+        cairo_surface_destroy(priv->back_surf);
+        priv->back_surf = NULL;
+    }
+    gtk_widget_queue_draw(view);
+}
+
 /* slope/view.c */
@@ -76,6 +76,18 @@ slope_public GtkWidget*
 slope_view_new_for_figure (slope_figure_t *figure);
 
 
+/**
+ * @brief Discards the cached rendering, item layers included, and
+ * schedules a full redraw.
+ *
+ * Changes made through the figure, metrics and item functions are
+ * picked up automatically; call this after modifying plotted data
+ * in place. The axis ranges are kept, see slope_figure_update()
+ * to rescale them as well.
+ */
+slope_public void slope_view_redraw (GtkWidget *view);
+
+
 SLOPE_END_DECLS
 
 #endif /* SLOPE_VIEW_H */
@@ -19,6 +19,7 @@
 
 #include "slope/xyaxis_p.h"
 #include "slope/xymetrics_p.h"
+#include "slope/figure_p.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -27,15 +28,11 @@
 
 slope_item_class_t* __slope_xyaxis_get_class()
 {
-    static int first_call = SLOPE_TRUE;
-    static slope_item_class_t klass;
-
-    if (first_call) {
-        klass.destroy_fn = NULL;
-        klass.draw_fn = __slope_xyaxis_draw;
-        klass.draw_thumb_fn = NULL;
-        first_call = SLOPE_FALSE;
-    }
+    static slope_item_class_t klass = {
+        __slope_xyaxis_destroy,
+        __slope_xyaxis_draw,
+        NULL
+    };
 
     return &klass;
 }
@@ -55,42 +52,107 @@ slope_item_t* slope_xyaxis_create (slope_metrics_t *metrics,
     parent->has_thumb = SLOPE_FALSE;
     parent->metrics = metrics;
     parent->klass = __slope_xyaxis_get_class();
+    __slope_item_init_layer(parent);
+
+    axis->length = 0.0;
+    axis->labels = NULL;
+    axis->labels_alloc = 0;
+    axis->ticks_revision = -1;
+    axis->max_label_width = 0.0;
+    axis->name_width = axis->name_height = 0.0;
+    axis->layout_name = NULL;
+    __slope_item_font_init(&axis->font);
 
     return parent;
 }
 
 
+void __slope_xyaxis_destroy (slope_item_t *item)
+{
+    slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
+    free(axis->labels);
+    free(axis->layout_name);
+    __slope_item_font_clear(&axis->font);
+}
+
+
+/**
+ * The ticks of the metrics along the axis.
+ */
+static const slope_ticks_t*
+__slope_xyaxis_get_ticks (const slope_item_t *item,
+                          const slope_metrics_t *metrics)
+{
+    const slope_xyaxis_t *axis = (const slope_xyaxis_t*) item;
+    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
+    if (axis->type == SLOPE_XYAXIS_TOP || axis->type == SLOPE_XYAXIS_BOTTOM) {
+        return &xymetr->xticks;
+    }
+    return &xymetr->yticks;
+}
+
+
 void __slope_xyaxis_setup_draw (slope_item_t *item, cairo_t *cr,
                                 const slope_metrics_t *metrics)
 {
     slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
-    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
+    const slope_ticks_t *ticks = __slope_xyaxis_get_ticks(item, metrics);
 
-    switch (axis->type) {
-        case SLOPE_XYAXIS_TOP:
-            axis->length = metrics->width_figure;
-            axis->divlen = xymetr->xmax - xymetr->xmin;
-            axis->divnum = axis->length / 70.0;
-            break;
-        case SLOPE_XYAXIS_BOTTOM:
-            axis->length = metrics->width_figure;
-            axis->divlen = xymetr->xmax - xymetr->xmin;
-            axis->divnum = axis->length / 70.0;
-            break;
-        case SLOPE_XYAXIS_LEFT:
-            axis->length = metrics->height_figure;
-            axis->divlen = xymetr->ymax - xymetr->ymin;
-            axis->divnum = axis->length / 50.0;
-            break;
-        case SLOPE_XYAXIS_RIGHT:
-            axis->length = metrics->height_figure;
-            axis->divlen = xymetr->ymax - xymetr->ymin;
-            axis->divnum = axis->length / 50.0;
-            break;
+    if (axis->type == SLOPE_XYAXIS_TOP || axis->type == SLOPE_XYAXIS_BOTTOM) {
+        axis->length = metrics->width_figure;
+    }
+    else {
+        axis->length = metrics->height_figure;
+    }
+
+    int same_font = __slope_item_font_check(&axis->font, cr);
+    int same_name = axis->layout_name != NULL
+        && strcmp(axis->layout_name, item->name) == 0;
+    if (same_font && same_name && axis->ticks_revision == ticks->revision) {
+        return;
+    }
+    axis->ticks_revision = ticks->revision;
+
+    /* measure the labels of the major ticks */
+    if (ticks->nticks > axis->labels_alloc) {
+        free(axis->labels);
+        axis->labels = malloc(ticks->nticks*sizeof(slope_xyaxis_label_t));
+        axis->labels_alloc = axis->labels ? ticks->nticks : 0;
+        /* try again on the next draw */
+        if (axis->labels == NULL) axis->ticks_revision = -1;
+    }
+    axis->max_label_width = 0.0;
+    int k;
+    for (k=0; k<ticks->nticks && k<axis->labels_alloc; k++) {
+        if (ticks->ticks[k].major) {
+            cairo_text_extents_t txt_ext;
+            cairo_text_extents(cr, ticks->ticks[k].label, &txt_ext);
+            axis->labels[k].width = txt_ext.width;
+            axis->labels[k].height = txt_ext.height;
+            if (txt_ext.width > axis->max_label_width)
+                axis->max_label_width = txt_ext.width;
+        }
+    }
+
+    cairo_text_extents_t txt_ext;
+    cairo_text_extents(cr, item->name, &txt_ext);
+    axis->name_width = txt_ext.width;
+    axis->name_height = txt_ext.height;
+    if (same_name == SLOPE_FALSE) {
+        free(axis->layout_name);
+        axis->layout_name = strdup(item->name);
     }
-    axis->divlen /= axis->divnum;
-    axis->divnum *= 5.0;
-    axis->divlen /= 5.0;
+}
+
+
+const slope_xyaxis_label_t* __slope_xyaxis_label (const slope_xyaxis_t *axis,
+                                                  int k)
+{
+    /* labels left unmeasured for lack of memory are drawn as if
+       they had no size */
+    static const slope_xyaxis_label_t unmeasured = { 0.0, 0.0 };
+    if (k >= axis->labels_alloc) return &unmeasured;
+    return &axis->labels[k];
 }
 
 
@@ -103,7 +165,9 @@ void __slope_xyaxis_draw (slope_item_t *item, cairo_t *cr,
     cairo_set_line_width(cr, 1.0);
     cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
 
-    __slope_xyaxis_setup_draw(item, cr, metrics);
+    if (__slope_figure_geometry_frozen(metrics->figure) == SLOPE_FALSE) {
+        __slope_xyaxis_setup_draw(item, cr, metrics);
+    }
 
     switch (axis->type) {
         case SLOPE_XYAXIS_TOP:
@@ -126,40 +190,33 @@ void __slope_xyaxis_draw_top (slope_item_t *item, cairo_t *cr,
                               const slope_metrics_t *metrics)
 {
     slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
-    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
 
     double x = metrics->xmin_figure;
     double y = metrics->ymin_figure;
-    double coord = xymetr->xmin;
-    char label[32];
 
     cairo_move_to(cr, x, y);
     cairo_line_to(cr, x+axis->length, y);
 
+    const slope_ticks_t *ticks = __slope_xyaxis_get_ticks(item, metrics);
     int k;
-    for (k=0; k<=axis->divnum; k++) {
+    for (k=0; k<ticks->nticks; k++) {
+        const slope_tick_t *tick = &ticks->ticks[k];
+        const slope_xyaxis_label_t *label = __slope_xyaxis_label(axis, k);
+        x = tick->pos;
         cairo_move_to(cr, x, y);
-        if (k%5 == 0) {
-            sprintf(label, "%2.2lf", coord);
-            cairo_text_extents_t txt_ext;
-            cairo_text_extents(cr, label, &txt_ext);
+        if (tick->major) {
             cairo_line_to(cr, x, y+8.0);
-            cairo_move_to(cr, x-txt_ext.width/2, y-txt_ext.height);
-            cairo_show_text(cr, label);
+            cairo_move_to(cr, x-label->width/2, y-label->height);
+            __slope_figure_show_text(metrics->figure, cr, tick->label);
         }
         else {
             cairo_line_to(cr, x, y+4.0);
         }
-        coord += axis->divlen;
-        x = slope_xymetrics_map_x(metrics, coord);
     }
-    sprintf(label, "%s", item->name);
-    cairo_text_extents_t txt_ext;
-    cairo_text_extents(cr, item->name, &txt_ext);
-    x = metrics->xmin_figure + (metrics->width_figure - txt_ext.width)/2.0;
-    y = y - 3.0*txt_ext.height;
+    x = metrics->xmin_figure + (metrics->width_figure - axis->name_width)/2.0;
+    y = y - 3.0*axis->name_height;
     cairo_move_to(cr, x, y);
-    cairo_show_text(cr, item->name);
+    __slope_figure_show_text(metrics->figure, cr, item->name);
     
     cairo_stroke(cr);
 }
@@ -169,40 +226,33 @@ void __slope_xyaxis_draw_bottom (slope_item_t *item, cairo_t *cr,
                                  const slope_metrics_t *metrics)
 {
     slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
-    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
 
     double x = metrics->xmin_figure;
     double y = metrics->ymax_figure;
-    double coord = xymetr->xmin;
-    char label[32];
 
     cairo_move_to(cr, x, y);
     cairo_line_to(cr, x+axis->length, y);
 
+    const slope_ticks_t *ticks = __slope_xyaxis_get_ticks(item, metrics);
     int k;
-    for (k=0; k<=axis->divnum; k++) {
+    for (k=0; k<ticks->nticks; k++) {
+        const slope_tick_t *tick = &ticks->ticks[k];
+        const slope_xyaxis_label_t *label = __slope_xyaxis_label(axis, k);
+        x = tick->pos;
         cairo_move_to(cr, x, y);
-        if (k%5 == 0) {
-            sprintf(label, "%2.2lf", coord);
-            cairo_text_extents_t txt_ext;
-            cairo_text_extents(cr, label, &txt_ext);
+        if (tick->major) {
             cairo_line_to(cr, x, y-8.0);
-            cairo_move_to(cr, x-txt_ext.width/2, y+2*txt_ext.height);
-            cairo_show_text(cr, label);
+            cairo_move_to(cr, x-label->width/2, y+2*label->height);
+            __slope_figure_show_text(metrics->figure, cr, tick->label);
         }
         else {
             cairo_line_to(cr, x, y-4.0);
         }
-        coord += axis->divlen;
-        x = slope_xymetrics_map_x(metrics, coord);
     }
-    sprintf(label, "%s", item->name);
-    cairo_text_extents_t txt_ext;
-    cairo_text_extents(cr, item->name, &txt_ext);
-    x = metrics->xmin_figure + (metrics->width_figure - txt_ext.width)/2.0;
-    y = y + 3.2*txt_ext.height;
+    x = metrics->xmin_figure + (metrics->width_figure - axis->name_width)/2.0;
+    y = y + 3.2*axis->name_height;
     cairo_move_to(cr, x, y);
-    cairo_show_text(cr, item->name);
+    __slope_figure_show_text(metrics->figure, cr, item->name);
     
     cairo_stroke(cr);
 }
@@ -212,45 +262,36 @@ void __slope_xyaxis_draw_left (slope_item_t *item, cairo_t *cr,
                                const slope_metrics_t *metrics)
 {
     slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
-    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
 
     double x = metrics->xmin_figure;
     double y = metrics->ymax_figure;
-    double coord = xymetr->ymin;
-    char label[32];
-    double max_txt_wid = 0.0;
     
     cairo_move_to(cr, x, y);
     cairo_line_to(cr, x, y-axis->length);
 
+    const slope_ticks_t *ticks = __slope_xyaxis_get_ticks(item, metrics);
     int k;
-    for (k=0; k<=axis->divnum; k++) {
+    for (k=0; k<ticks->nticks; k++) {
+        const slope_tick_t *tick = &ticks->ticks[k];
+        const slope_xyaxis_label_t *label = __slope_xyaxis_label(axis, k);
+        y = tick->pos;
         cairo_move_to(cr, x, y);
-        if (k%5 == 0) {
-            sprintf(label, "%2.2lf", coord);
-            cairo_text_extents_t txt_ext;
-            cairo_text_extents(cr, label, &txt_ext);
-            if (txt_ext.width > max_txt_wid) max_txt_wid = txt_ext.width;
+        if (tick->major) {
             cairo_line_to(cr, x+8.0, y);
             cairo_move_to(
-                cr, x-txt_ext.width-txt_ext.height, y+0.5*txt_ext.height);
-            cairo_show_text(cr, label);
+                cr, x-label->width-label->height, y+0.5*label->height);
+            __slope_figure_show_text(metrics->figure, cr, tick->label);
         }
         else {
             cairo_line_to(cr, x+4.0, y);
         }
-        coord += axis->divlen;
-        y = slope_xymetrics_map_y(metrics, coord);
     }
     cairo_save(cr);
     cairo_rotate(cr, -M_PI/2.0);
-    sprintf(label, "%s", item->name);
-    cairo_text_extents_t txt_ext;
-    cairo_text_extents(cr, item->name, &txt_ext);
-    x = - metrics->ymin_figure - (metrics->height_figure + txt_ext.width)/2.0;
-    y = metrics->xmin_figure - max_txt_wid - 2.0*txt_ext.height;
+    x = - metrics->ymin_figure - (metrics->height_figure + axis->name_width)/2.0;
+    y = metrics->xmin_figure - axis->max_label_width - 2.0*axis->name_height;
     cairo_move_to(cr, x, y);
-    cairo_show_text(cr, item->name);
+    __slope_figure_show_text(metrics->figure, cr, item->name);
     cairo_restore(cr);
     cairo_stroke(cr);
 }
@@ -260,44 +301,35 @@ void __slope_xyaxis_draw_right (slope_item_t *item, cairo_t *cr,
                                 const slope_metrics_t *metrics)
 {
     slope_xyaxis_t *axis = (slope_xyaxis_t*) item;
-    const slope_xymetrics_t *xymetr = (const slope_xymetrics_t*) metrics;
 
     double x = metrics->xmax_figure;
     double y = metrics->ymax_figure;
-    double coord = xymetr->ymin;
-    char label[32];
-    double max_txt_wid = 0.0;
 
     cairo_move_to(cr, x, y);
     cairo_line_to(cr, x, y-axis->length);
 
+    const slope_ticks_t *ticks = __slope_xyaxis_get_ticks(item, metrics);
     int k;
-    for (k=0; k<=axis->divnum; k++) {
+    for (k=0; k<ticks->nticks; k++) {
+        const slope_tick_t *tick = &ticks->ticks[k];
+        const slope_xyaxis_label_t *label = __slope_xyaxis_label(axis, k);
+        y = tick->pos;
         cairo_move_to(cr, x, y);
-        if (k%5 == 0) {
-            sprintf(label, "%2.2lf", coord);
-            cairo_text_extents_t txt_ext;
-            cairo_text_extents(cr, label, &txt_ext);
-            if (txt_ext.width > max_txt_wid) max_txt_wid = txt_ext.width;
+        if (tick->major) {
             cairo_line_to(cr, x-8.0, y);
-            cairo_move_to(cr, x+txt_ext.height, y+0.5*txt_ext.height);
-            cairo_show_text(cr, label);
+            cairo_move_to(cr, x+label->height, y+0.5*label->height);
+            __slope_figure_show_text(metrics->figure, cr, tick->label);
         }
         else {
             cairo_line_to(cr, x-4.0, y);
         }
-        coord += axis->divlen;
-        y = slope_xymetrics_map_y(metrics, coord);
     }
     cairo_save(cr);
     cairo_rotate(cr, -M_PI/2.0);
-    sprintf(label, "%s", item->name);
-    cairo_text_extents_t txt_ext;
-    cairo_text_extents(cr, item->name, &txt_ext);
-    x = - metrics->ymin_figure - (metrics->height_figure + txt_ext.width)/2.0;
-    y = metrics->xmax_figure + max_txt_wid + 2.6*txt_ext.height;
+    x = - metrics->ymin_figure - (metrics->height_figure + axis->name_width)/2.0;
+    y = metrics->xmax_figure + axis->max_label_width + 2.6*axis->name_height;
     cairo_move_to(cr, x, y);
-    cairo_show_text(cr, item->name);
+    __slope_figure_show_text(metrics->figure, cr, item->name);
     cairo_restore(cr);
     cairo_stroke(cr);
 }
@@ -27,14 +27,31 @@ SLOPE_BEGIN_DECLS
 
 typedef struct _slope_xyaxis slope_xyaxis_t;
 
+/**
+ * Extents of the label of a tick.
+ */
+typedef struct _slope_xyaxis_label
+{
+    double width, height;
+}
+slope_xyaxis_label_t;
+
 struct _slope_xyaxis
 {
     slope_item_t parent;
     slope_xyaxis_type_t type;
     slope_color_t color;
     double length;
-    double divlen;
-    int divnum;
+    /* extents of the labels of the metrics' tick table, reused while
+       the table, the font and the name stay those they were measured
+       for */
+    slope_xyaxis_label_t *labels;
+    int labels_alloc;
+    int ticks_revision;
+    double max_label_width;
+    double name_width, name_height;
+    char *layout_name;
+    slope_item_font_t font;
 };
 
 /**
@@ -43,9 +60,21 @@ slope_item_class_t* __slope_xyaxis_get_class();
 
 /**
  */
+void __slope_xyaxis_destroy (slope_item_t *item);
+
+/**
+ * Measures the labels of the axis, unless the last measures still
+ * hold.
+ */
 void __slope_xyaxis_setup_draw (slope_item_t *item, cairo_t *cr,
                                 const slope_metrics_t *metrics);
 
+/**
+ * Extents of the label of tick k, zero if it couldn't be measured.
+ */
+const slope_xyaxis_label_t* __slope_xyaxis_label (const slope_xyaxis_t *axis,
+                                                  int k);
+
 /**
  */
 void __slope_xyaxis_draw (slope_item_t *item, cairo_t *cr,
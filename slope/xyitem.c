@@ -19,25 +19,32 @@
 
 #include "slope/xyitem_p.h"
 #include "slope/xymetrics_p.h"
+#include "slope/figure_p.h"
+#include "slope/range_p.h"
+#include "slope/dataview_p.h"
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <limits.h>
+#if !defined(_WIN32)
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
 
 #define SYMBRAD 3.0
-#define SYMBRADSQR 9.0
-#define TWOSYMBRADSQR 36.0
+#define SLOPE_XYITEM_CHUNK 512
+#define SLOPE_XYITEM_SCAN_CHUNK 4096
 
 
 slope_item_class_t* __slope_xyitem_get_class()
 {
-    static int first_call = SLOPE_TRUE;
-    static slope_item_class_t klass;
-
-    if (first_call) {
-        klass.destroy_fn = NULL;
-        klass.draw_fn = __slope_xyitem_draw;
-        klass.draw_thumb_fn = __slope_xyitem_draw_thumb;
-        first_call = SLOPE_FALSE;
-    }
+    static slope_item_class_t klass = {
+        __slope_xyitem_destroy,
+        __slope_xyitem_draw,
+        __slope_xyitem_draw_thumb
+    };
 
     return &klass;
 }
@@ -46,18 +53,50 @@ slope_item_class_t* __slope_xyitem_get_class()
 void __slope_xyitem_init (slope_item_t *parent)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) parent;
+    self->vx = self->vy = NULL;
+    slope_dataview_init(&self->xview, NULL, SLOPE_DOUBLE, 0, 0);
+    slope_dataview_init(&self->yview, NULL, SLOPE_DOUBLE, 0, 0);
+    self->n = 0;
+    self->stream = NULL;
+    self->xvec = self->yvec = NULL;
+    self->map = NULL;
+    self->map_size = 0;
+    self->x_sorted = SLOPE_FALSE;
+    self->has_finite = SLOPE_FALSE;
+    self->xmin = self->xmax = 0.0;
+    self->ymin = self->ymax = 0.0;
     self->antialias = SLOPE_TRUE;
+    self->decimate = SLOPE_TRUE;
+    self->use_lod = SLOPE_TRUE;
+    __slope_lod_init(&self->lod);
     self->line_width = 1.0;
     self->fill_symbol = SLOPE_TRUE;
+    self->symbol_radius = SYMBRAD;
+    self->sprite.pattern = NULL;
     self->rescalable = SLOPE_TRUE;
     parent->name = NULL;
     parent->visible = SLOPE_TRUE;
     parent->has_thumb = SLOPE_TRUE;
     parent->metrics = NULL;
+    __slope_item_init_layer(parent);
     parent->klass = __slope_xyitem_get_class();
 }
 
 
+void __slope_xyitem_destroy (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    __slope_xyitem_clear_sprite(item);
+    __slope_lod_clear(&self->lod);
+    __slope_stream_destroy(self->stream);
+    slope_vector_destroy(self->xvec);
+    slope_vector_destroy(self->yvec);
+#if !defined(_WIN32)
+    if (self->map) munmap(self->map, self->map_size);
+#endif
+}
+
+
 slope_item_t* slope_xyitem_create()
 {
     slope_xyitem_t *self = malloc(sizeof(slope_xyitem_t));
@@ -87,9 +126,7 @@ void slope_xyitem_set (slope_item_t *item,
                        const char *fmt)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
-    self->vx = vx;
-    self->vy = vy;
-    self->n = n;
+    __slope_xyitem_set_doubles(item, vx, vy, n);
     if (item->name) {
         free(item->name);
     }
@@ -97,6 +134,9 @@ void slope_xyitem_set (slope_item_t *item,
     slope_color_set_name(&self->color, __slope_item_parse_color(fmt));
     self->scatter = __slope_item_parse_scatter(fmt);
     __slope_xyitem_check_ranges(item);
+    __slope_xyitem_update_lod(item);
+    /* renamed without going through slope_item_set_name */
+    __slope_figure_invalidate_legend(slope_metrics_get_figure(item->metrics));
     slope_item_notify_data_change(item);
 }
 
@@ -105,11 +145,9 @@ void slope_xyitem_set_item (slope_item_t *item,
                             const double *vx, const double *vy,
                             const int n)
 {
-    slope_xyitem_t *self = (slope_xyitem_t*) item;
-    self->vx = vx;
-    self->vy = vy;
-    self->n = n;
+    __slope_xyitem_set_doubles(item, vx, vy, n);
     __slope_xyitem_check_ranges(item);
+    __slope_xyitem_update_lod(item);
     slope_item_notify_data_change(item);
 }
 
@@ -118,10 +156,11 @@ void slope_xyitem_update_item (slope_item_t *item,
                                const double *vx, const double *vy,
                                const int n)
 {
-    slope_xyitem_t *self = (slope_xyitem_t*) item;
-    self->vx = vx;
-    self->vy = vy;
-    self->n = n;
+    __slope_xyitem_set_doubles(item, vx, vy, n);
+    /* the metrics keep their scale, but the item's own bounds,
+       sorted flag and pyramid must follow the new data */
+    __slope_xyitem_check_ranges(item);
+    __slope_xyitem_update_lod(item);
     slope_item_notify_appearence_change(item);
 }
 
@@ -130,6 +169,19 @@ void __slope_xyitem_draw (slope_item_t *item, cairo_t *cr,
                           const slope_metrics_t *metrics)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
+    int begin, end;
+
+    /* vectors changed without a sync may have moved or outgrown the
+       pyramid, so they are synced before reading them */
+    if (self->xvec && __slope_xyitem_vectors_changed(item)
+            && __slope_figure_geometry_frozen(metrics->figure) == SLOPE_FALSE) {
+        __slope_xyitem_sync_vectors(item);
+    }
+    if (__slope_xyitem_visible_range(
+            item, metrics, self->symbol_radius + self->line_width,
+            &begin, &end) == SLOPE_FALSE) {
+        return;
+    }
 
     slope_cairo_set_color(cr, &self->color);
     if (self->antialias) {
@@ -144,174 +196,458 @@ void __slope_xyitem_draw (slope_item_t *item, cairo_t *cr,
 
     switch (self->scatter) {
         case SLOPE_LINE:
-            __slope_xyitem_draw_line(item, cr, metrics);
+            __slope_xyitem_draw_line(item, cr, metrics, begin, end);
             break;
         case SLOPE_CIRCLES:
-            __slope_xyitem_draw_circles(item, cr, metrics);
-            break;
         case SLOPE_TRIANGLES:
-            __slope_xyitem_draw_triangles(item, cr, metrics);
-            break;
         case SLOPE_SQUARES:
-            __slope_xyitem_draw_squares(item, cr, metrics);
-            break;
         case SLOPE_PLUSSES:
-            __slope_xyitem_draw_plusses(item, cr, metrics);
+            __slope_xyitem_draw_symbols(item, cr, metrics, begin, end);
             break;
     }
 }
 
 
 void __slope_xyitem_draw_line (slope_item_t *item, cairo_t *cr,
-                               const slope_metrics_t *metrics)
+                               const slope_metrics_t *metrics,
+                               int begin, int end)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
 
-    const double *vx = self->vx;
-    const double *vy = self->vy;
-    const int n = self->n;
+    slope_point_t pts[SLOPE_XYITEM_CHUNK];
+    slope_xyitem_m4_t m4;
+    int start, k;
 
-    double x1 = slope_xymetrics_map_x(metrics, vx[0]);
-    double y1 = slope_xymetrics_map_y(metrics, vy[0]);
-    cairo_move_to(cr, x1, y1);
+    __slope_xyitem_m4_init(&m4, cr);
+    /* a recording has no pixel columns of its own until replayed */
+    const int decimate = self->decimate && m4.aligned
+        && cairo_surface_get_type(cairo_get_target(cr))
+           != CAIRO_SURFACE_TYPE_RECORDING;
 
-    int k;
-    for (k=1; k<n; k++) {
-        double x2 = slope_xymetrics_map_x(metrics, vx[k]);
-        double y2 = slope_xymetrics_map_y(metrics, vy[k]);
+    /* with many samples per pixel, walk the pyramid at the coarsest
+       level whose blocks still fit well inside a pixel column */
+    if (decimate && self->lod.nlevels > 0) {
+        double spp = (end - begin) /(metrics->width_figure*fabs(m4.xscale));
+        int level = self->lod.nlevels - 1;
+        while (level >= 0 && 2*__slope_lod_block_size(level) > spp) {
+            --level;
+        }
+        if (level >= 0) {
+            __slope_xyitem_draw_line_lod(item, &m4, metrics,
+                                         level, begin, end);
+            return;
+        }
+    }
 
-        double dx = x2 - x1;
-        double dy = y2 - y1;
-        double distsqr = dx*dx + dy*dy;
+    for (start=begin; start<end; start+=SLOPE_XYITEM_CHUNK) {
+        int count = end - start;
+        if (count > SLOPE_XYITEM_CHUNK) count = SLOPE_XYITEM_CHUNK;
+        __slope_xyitem_map_chunk(item, metrics, start, count, pts);
 
-        if (distsqr >= SYMBRADSQR) {
-            cairo_line_to(cr, x2, y2);
-            x1 = x2;
-            y1 = y2;
+        if (decimate == SLOPE_FALSE) {
+            for (k=0; k<count; k++) {
+                if (isfinite(pts[k].x) && isfinite(pts[k].y)) {
+                    __slope_xyitem_m4_emit(&m4, &pts[k]);
+                }
+                else {
+                    m4.emitted = 0;
+                }
+            }
+            continue;
+        }
+        for (k=0; k<count; k++) {
+            __slope_xyitem_m4_push(&m4, pts[k].x, pts[k].y);
         }
     }
+    __slope_xyitem_m4_flush(&m4);
     cairo_stroke(cr);
+    __slope_figure_stats_count(metrics->figure, end - begin, m4.drawn);
 }
 
 
-void __slope_xyitem_draw_circles (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics)
+void __slope_xyitem_draw_line_lod (slope_item_t *item, slope_xyitem_m4_t *m4,
+                                   const slope_metrics_t *metrics,
+                                   int level, int begin, int end)
 {
-    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    const int shift = SLOPE_LOD_SHIFT + level;
+    int block;
 
-    const double *vx = self->vx;
-    const double *vy = self->vy;
-    const int n = self->n;
+    for (block = begin >> shift; block <= (end-1) >> shift; block++) {
+        __slope_xyitem_lod_push(item, m4, metrics,
+                                level, block, begin, end);
+    }
+    __slope_xyitem_m4_flush(m4);
+    cairo_stroke(m4->cr);
+    __slope_figure_stats_count(metrics->figure, end - begin, m4->drawn);
+}
 
-    double x1 = slope_xymetrics_map_x(metrics, vx[0]);
-    double y1 = slope_xymetrics_map_y(metrics, vy[0]);
-    cairo_move_to(cr, x1+SYMBRAD, y1);
-    cairo_arc(cr, x1, y1, SYMBRAD, 0.0, 6.283185);
-    if (self->fill_symbol) cairo_fill(cr);
 
+void __slope_xyitem_lod_push (slope_item_t *item, slope_xyitem_m4_t *m4,
+                              const slope_metrics_t *metrics,
+                              int level, int block, int begin, int end)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    const int start = block << (SLOPE_LOD_SHIFT + level);
+    int stop = start + __slope_lod_block_size(level);
     int k;
-    for (k=1; k<n; k++) {
-        double x2 = slope_xymetrics_map_x(metrics, vx[k]);
-        double y2 = slope_xymetrics_map_y(metrics, vy[k]);
-
-        double dx = x2 - x1;
-        double dy = y2 - y1;
-        double distsqr = dx*dx + dy*dy;
-
-        if (distsqr >= TWOSYMBRADSQR) {
-            cairo_move_to(cr, x2+SYMBRAD, y2);
-            cairo_arc(cr, x2, y2, SYMBRAD, 0.0, 6.283185);
-            if (self->fill_symbol) cairo_fill(cr);
-            x1 = x2;
-            y1 = y2;
+
+    if (stop > self->n) stop = self->n;
+    if (start >= end || stop <= begin) return;
+
+    /* a block crossing a column boundary or the ends of the slice is
+       refined, so the result is the same as pushing every sample */
+    const slope_lod_entry_t *entry = &self->lod.level[level][block];
+    int refine = start < begin || stop > end || entry->imin == SLOPE_LOD_GAP;
+    if (refine == SLOPE_FALSE) {
+        double x1 = slope_xymetrics_map_x(
+            metrics, __slope_xyitem_x_at(self, start));
+        double x2 = slope_xymetrics_map_x(
+            metrics, __slope_xyitem_x_at(self, stop-1));
+        refine = __slope_xyitem_m4_column(m4, x1)
+                 != __slope_xyitem_m4_column(m4, x2);
+    }
+    if (refine) {
+        if (level == 0) {
+            if (start < begin) k = begin;
+            else k = start;
+            for (; k<stop && k<end; k++) {
+                __slope_xyitem_push_sample(item, m4, metrics, k);
+            }
+        }
+        else {
+            __slope_xyitem_lod_push(item, m4, metrics, level-1,
+                                    2*block, begin, end);
+            __slope_xyitem_lod_push(item, m4, metrics, level-1,
+                                    2*block+1, begin, end);
         }
+        return;
+    }
+
+    /* otherwise its first, extremes and last samples give the
+       column the same M4 summary as all of its samples */
+    int i1 = entry->imin;
+    int i2 = entry->imax;
+    if (i2 < i1) {
+        i1 = entry->imax;
+        i2 = entry->imin;
+    }
+    __slope_xyitem_push_sample(item, m4, metrics, start);
+    if (i1 != start && i1 != stop-1) {
+        __slope_xyitem_push_sample(item, m4, metrics, i1);
+    }
+    if (i2 != i1 && i2 != start && i2 != stop-1) {
+        __slope_xyitem_push_sample(item, m4, metrics, i2);
+    }
+    if (stop-1 != start) {
+        __slope_xyitem_push_sample(item, m4, metrics, stop-1);
     }
-    cairo_stroke(cr);
 }
 
 
-void __slope_xyitem_draw_triangles (slope_item_t *item, cairo_t *cr,
-                                    const slope_metrics_t *metrics)
+void __slope_xyitem_push_sample (slope_item_t *item, slope_xyitem_m4_t *m4,
+                                 const slope_metrics_t *metrics, int k)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
+    __slope_xyitem_m4_push(m4,
+        slope_xymetrics_map_x(metrics, __slope_xyitem_x_at(self, k)),
+        slope_xymetrics_map_y(metrics, __slope_xyitem_y_at(self, k)));
+}
 
-    const double *vx = self->vx;
-    const double *vy = self->vy;
-    const int n = self->n;
 
-    double x1 = slope_xymetrics_map_x(metrics, vx[0]);
-    double y1 = slope_xymetrics_map_y(metrics, vy[0]);
-    cairo_move_to(cr, x1-SYMBRAD, y1+SYMBRAD);
-    cairo_line_to(cr, x1+SYMBRAD, y1+SYMBRAD);
-    cairo_line_to(cr, x1, y1-SYMBRAD);
-    cairo_close_path(cr);
-    if (self->fill_symbol) cairo_fill(cr);
+void __slope_xyitem_update_lod (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->use_lod && self->x_sorted && self->stream == NULL) {
+        __slope_lod_build(&self->lod, &self->yview, self->n);
+    }
+    else {
+        __slope_lod_clear(&self->lod);
+    }
+}
 
-    int k;
-    for (k=1; k<n; k++) {
-        double x2 = slope_xymetrics_map_x(metrics, vx[k]);
-        double y2 = slope_xymetrics_map_y(metrics, vy[k]);
-
-        double dx = x2 - x1;
-        double dy = y2 - y1;
-        double distsqr = dx*dx + dy*dy;
-
-        if (distsqr >= TWOSYMBRADSQR) {
-            cairo_move_to(cr, x2-SYMBRAD, y2+SYMBRAD);
-            cairo_line_to(cr, x2+SYMBRAD, y2+SYMBRAD);
-            cairo_line_to(cr, x2, y2-SYMBRAD);
-            cairo_close_path(cr);
-            if (self->fill_symbol) cairo_fill(cr);
-            x1 = x2;
-            y1 = y2;
-        }
+
+void __slope_xyitem_m4_init (slope_xyitem_m4_t *m4, cairo_t *cr)
+{
+    /* the device transform of the surface, e.g. a hi-DPI scale, is
+       part of what cairo_user_to_device() applies */
+    double ox = 0.0, oy = 0.0;
+    double ux = 1.0, uy = 0.0;
+    double vx = 0.0, vy = 1.0;
+    cairo_user_to_device(cr, &ox, &oy);
+    cairo_user_to_device(cr, &ux, &uy);
+    cairo_user_to_device(cr, &vx, &vy);
+
+    m4->cr = cr;
+    m4->emitted = 0;
+    m4->drawn = 0;
+    m4->npts = 0;
+    m4->xscale = ux - ox;
+    m4->xoffset = ox;
+    m4->aligned = uy == oy && vx == ox && m4->xscale != 0.0;
+}
+
+
+double __slope_xyitem_m4_column (const slope_xyitem_m4_t *m4, double x)
+{
+    return floor(m4->xscale*x + m4->xoffset);
+}
+
+
+void __slope_xyitem_m4_emit (slope_xyitem_m4_t *m4,
+                             const slope_point_t *p)
+{
+    if (m4->emitted == 0) {
+        cairo_move_to(m4->cr, p->x, p->y);
     }
-    cairo_stroke(cr);
+    else {
+        cairo_line_to(m4->cr, p->x, p->y);
+    }
+    m4->emitted += 1;
+    m4->drawn += 1;
 }
 
 
-void __slope_xyitem_draw_squares (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics)
+void __slope_xyitem_m4_push (slope_xyitem_m4_t *m4, double x, double y)
 {
-    
+    double column = __slope_xyitem_m4_column(m4, x);
+
+    /* NaN or infinite samples are gaps, the line restarts after them */
+    if (!isfinite(x) || !isfinite(y)) {
+        __slope_xyitem_m4_flush(m4);
+        m4->emitted = 0;
+        return;
+    }
+    if (m4->npts > 0 && column != m4->column) {
+        __slope_xyitem_m4_flush(m4);
+    }
+    if (m4->npts == 0) {
+        m4->column = column;
+        m4->first.x = m4->last.x = m4->min.x = m4->max.x = x;
+        m4->first.y = m4->last.y = m4->min.y = m4->max.y = y;
+        m4->min_seq = m4->max_seq = 0;
+        m4->npts = 1;
+        return;
+    }
+    m4->last.x = x;
+    m4->last.y = y;
+    if (y < m4->min.y) {
+        m4->min = m4->last;
+        m4->min_seq = m4->npts;
+    }
+    if (y > m4->max.y) {
+        m4->max = m4->last;
+        m4->max_seq = m4->npts;
+    }
+    m4->npts += 1;
 }
 
 
-void __slope_xyitem_draw_plusses (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics)
+void __slope_xyitem_m4_flush (slope_xyitem_m4_t *m4)
+{
+    if (m4->npts == 0) return;
+
+    const int last_seq = m4->npts - 1;
+    const slope_point_t *p1 = &m4->min;
+    const slope_point_t *p2 = &m4->max;
+    int seq1 = m4->min_seq;
+    int seq2 = m4->max_seq;
+    if (seq2 < seq1) {
+        p1 = &m4->max;
+        p2 = &m4->min;
+        seq1 = m4->max_seq;
+        seq2 = m4->min_seq;
+    }
+
+    /* first, extremes in the order they appeared, then last, without
+       repeating the ones that are also the first or last points */
+    __slope_xyitem_m4_emit(m4, &m4->first);
+    if (seq1 != 0 && seq1 != last_seq) {
+        __slope_xyitem_m4_emit(m4, p1);
+    }
+    if (seq2 != 0 && seq2 != last_seq && seq2 != seq1) {
+        __slope_xyitem_m4_emit(m4, p2);
+    }
+    if (last_seq > 0) {
+        __slope_xyitem_m4_emit(m4, &m4->last);
+    }
+    m4->npts = 0;
+}
+
+
+void __slope_xyitem_draw_symbols (slope_item_t *item, cairo_t *cr,
+                                  const slope_metrics_t *metrics,
+                                  int begin, int end)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
-    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
-    
-    const double *vx = self->vx;
-    const double *vy = self->vy;
-    const int n = self->n;
-    
-    double x1 = slope_xymetrics_map_x(metrics, vx[0]);
-    double y1 = slope_xymetrics_map_y(metrics, vy[0]);
-    cairo_move_to(cr, x1-SYMBRAD, y1);
-    cairo_line_to(cr, x1+SYMBRAD, y1);
-    cairo_move_to(cr, x1, y1-SYMBRAD);
-    cairo_line_to(cr, x1, y1+SYMBRAD);
-    int k;
-    for (k=1; k<n; k++) {
-        double x2 = slope_xymetrics_map_x(metrics, vx[k]);
-        double y2 = slope_xymetrics_map_y(metrics, vy[k]);
-        
-        double dx = x2 - x1;
-        double dy = y2 - y1;
-        double distsqr = dx*dx + dy*dy;
-        
-        if (distsqr >= TWOSYMBRADSQR) {
-            cairo_move_to(cr, x1-SYMBRAD, y1);
-            cairo_line_to(cr, x1+SYMBRAD, y1);
-            cairo_move_to(cr, x1, y1-SYMBRAD);
-            cairo_line_to(cr, x1, y1+SYMBRAD);
+
+    const double mindistsqr = 4.0*self->symbol_radius*self->symbol_radius;
+    slope_point_t pts[SLOPE_XYITEM_CHUNK];
+    cairo_pattern_t *sprite = NULL;
+    double x1 = HUGE_VAL, y1 = HUGE_VAL;
+    long drawn = 0;
+    int start, k;
+
+    /* raster targets get a pre-rendered symbol stamped at each
+       position, vector targets a single path with every symbol. The
+       sprite has 1x pixels, so scaled or transformed contexts get the
+       path too */
+    if (__slope_item_target_is_raster(cr)
+            && __slope_item_pixel_aligned(cr)
+            && __slope_figure_shares_caches(metrics->figure)) {
+        sprite = __slope_xyitem_get_sprite(item);
+    }
+    if (self->scatter == SLOPE_PLUSSES) {
+        cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    }
+
+    for (start=begin; start<end; start+=SLOPE_XYITEM_CHUNK) {
+        int count = end - start;
+        if (count > SLOPE_XYITEM_CHUNK) count = SLOPE_XYITEM_CHUNK;
+        __slope_xyitem_map_chunk(item, metrics, start, count, pts);
+
+        for (k=0; k<count; k++) {
+            double x2 = pts[k].x;
+            double y2 = pts[k].y;
+            if (!isfinite(x2) || !isfinite(y2)) continue;
+
+            /* skip symbols that would mostly hide behind the last one */
+            double dx = x2 - x1;
+            double dy = y2 - y1;
+            if (dx*dx + dy*dy < mindistsqr) continue;
+
+            if (sprite) {
+                __slope_xyitem_stamp_sprite(item, cr, x2, y2);
+            }
+            else {
+                __slope_xyitem_symbol_path(item, cr, x2, y2);
+            }
             x1 = x2;
             y1 = y2;
+            drawn++;
         }
     }
-    cairo_stroke(cr);
+    __slope_figure_stats_count(metrics->figure, end - begin, drawn);
+
+    if (sprite == NULL) {
+        if (__slope_xyitem_symbol_filled(item)) cairo_fill(cr);
+        else cairo_stroke(cr);
+    }
+}
+
+
+void __slope_xyitem_symbol_path (slope_item_t *item, cairo_t *cr,
+                                 double x, double y)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    const double r = self->symbol_radius;
+
+    switch (self->scatter) {
+        case SLOPE_CIRCLES:
+            cairo_move_to(cr, x+r, y);
+            cairo_arc(cr, x, y, r, 0.0, 6.283185);
+            break;
+        case SLOPE_TRIANGLES:
+            cairo_move_to(cr, x-r, y+r);
+            cairo_line_to(cr, x+r, y+r);
+            cairo_line_to(cr, x, y-r);
+            cairo_close_path(cr);
+            break;
+        case SLOPE_SQUARES:
+            cairo_rectangle(cr, x-r, y-r, 2.0*r, 2.0*r);
+            break;
+        case SLOPE_PLUSSES:
+            cairo_move_to(cr, x-r, y);
+            cairo_line_to(cr, x+r, y);
+            cairo_move_to(cr, x, y-r);
+            cairo_line_to(cr, x, y+r);
+            break;
+        default:
+            break;
+    }
+}
+
+
+int __slope_xyitem_symbol_filled (const slope_item_t *item)
+{
+    const slope_xyitem_t *self = (const slope_xyitem_t*) item;
+    return self->fill_symbol && self->scatter != SLOPE_PLUSSES;
+}
+
+
+cairo_pattern_t* __slope_xyitem_get_sprite (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    slope_xyitem_sprite_t *sprite = &self->sprite;
+    const int antialias =
+        self->antialias && self->scatter != SLOPE_PLUSSES;
+
+    if (sprite->pattern != NULL
+        && sprite->scatter == self->scatter
+        && sprite->radius == self->symbol_radius
+        && sprite->line_width == self->line_width
+        && sprite->fill == self->fill_symbol
+        && sprite->antialias == antialias
+        && memcmp(&sprite->color, &self->color,
+                  sizeof(slope_color_t)) == 0) {
+        return sprite->pattern;
+    }
+    __slope_xyitem_clear_sprite(item);
+
+    /* the symbol is centered on the middle of pixel (half,half) */
+    sprite->half = (int) ceil(self->symbol_radius + self->line_width) + 1;
+    sprite->size = 2*sprite->half + 1;
+    sprite->scatter = self->scatter;
+    sprite->radius = self->symbol_radius;
+    sprite->line_width = self->line_width;
+    sprite->fill = self->fill_symbol;
+    sprite->antialias = antialias;
+    sprite->color = self->color;
+
+    cairo_surface_t *surf = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, sprite->size, sprite->size);
+    cairo_t *cr = cairo_create(surf);
+    slope_cairo_set_color(cr, &self->color);
+    cairo_set_line_width(cr, self->line_width);
+    cairo_set_antialias(cr, antialias ? CAIRO_ANTIALIAS_GRAY
+                                      : CAIRO_ANTIALIAS_NONE);
+    __slope_xyitem_symbol_path(item, cr, sprite->half + 0.5,
+                               sprite->half + 0.5);
+    if (__slope_xyitem_symbol_filled(item)) cairo_fill(cr);
+    else cairo_stroke(cr);
+    cairo_destroy(cr);
+
+    sprite->pattern = cairo_pattern_create_for_surface(surf);
+    cairo_surface_destroy(surf);
+    return sprite->pattern;
+}
+
+
+void __slope_xyitem_stamp_sprite (slope_item_t *item, cairo_t *cr,
+                                  double x, double y)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    slope_xyitem_sprite_t *sprite = &self->sprite;
+
+    /* pixel aligned boxes are a plain blit for cairo, user space
+       pixels being device pixels here */
+    double sx = floor(x) - sprite->half;
+    double sy = floor(y) - sprite->half;
+    cairo_matrix_t matrix;
+    cairo_matrix_init_translate(&matrix, -sx, -sy);
+    cairo_pattern_set_matrix(sprite->pattern, &matrix);
+    cairo_set_source(cr, sprite->pattern);
+    cairo_rectangle(cr, sx, sy, sprite->size, sprite->size);
+    cairo_fill(cr);
+}
+
+
+void __slope_xyitem_clear_sprite (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->sprite.pattern) {
+        cairo_pattern_destroy(self->sprite.pattern);
+        self->sprite.pattern = NULL;
+    }
 }
 
 
@@ -336,20 +672,19 @@ void __slope_xyitem_draw_thumb (slope_item_t *item,
             cairo_move_to(cr, pos->x - 10.0, pos->y - 3.0);
             cairo_line_to(cr, pos->x + 10.0, pos->y - 3.0);
             break;
-        case SLOPE_CIRCLES:
-            cairo_move_to(cr, pos->x + SYMBRAD, pos->y - SYMBRAD);
-            cairo_arc(cr, pos->x, pos->y - SYMBRAD, SYMBRAD, 0.0, 6.283185);
-            cairo_fill(cr);
         case SLOPE_PLUSSES:
             cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
-            cairo_move_to(cr, pos->x - SYMBRAD, pos->y - SYMBRAD);
-            cairo_line_to(cr, pos->x + SYMBRAD, pos->y - SYMBRAD);
-            cairo_move_to(cr, pos->x , pos->y - SYMBRAD - SYMBRAD);
-            cairo_line_to(cr, pos->x , pos->y + SYMBRAD - SYMBRAD);
+            __slope_xyitem_symbol_path(item, cr, pos->x, pos->y - SYMBRAD);
+            break;
+        default:
+            __slope_xyitem_symbol_path(item, cr, pos->x, pos->y - SYMBRAD);
+            if (__slope_xyitem_symbol_filled(item)) cairo_fill(cr);
             break;
     }
+    cairo_stroke(cr);
     cairo_move_to(cr, pos->x + 17.0, pos->y);
-    cairo_show_text(cr, item->name);
+    __slope_figure_show_text(slope_metrics_get_figure(item->metrics),
+                             cr, item->name);
     cairo_stroke(cr);
 }
 
@@ -357,18 +692,130 @@ void __slope_xyitem_draw_thumb (slope_item_t *item,
 void __slope_xyitem_check_ranges (slope_item_t *item)
 {
     slope_xyitem_t *self = (slope_xyitem_t*) item;
-    const double *vx = self->vx;
-    const double *vy = self->vy;
-    const int n = self->n;
-    self->xmin = self->xmax = vx[0];
-    self->ymin = self->ymax = vy[0];
-    int k;
-    for (k=1; k<n; k++) {
-        if (vx[k] < self->xmin) self->xmin = vx[k];
-        if (vx[k] > self->xmax) self->xmax = vx[k];
-        if (vy[k] < self->ymin) self->ymin = vy[k];
-        if (vy[k] > self->ymax) self->ymax = vy[k];
+    slope_range_t range;
+    if (self->stream) {
+        __slope_stream_get_range(self->stream, &range);
     }
+    else if (self->vx && self->vy) {
+        __slope_range_scan(&range, self->vx, self->vy, self->n);
+    }
+    else {
+        __slope_range_scan_views(&range, &self->xview, &self->yview, self->n);
+    }
+    self->xmin = range.xmin;
+    self->xmax = range.xmax;
+    self->ymin = range.ymin;
+    self->ymax = range.ymax;
+    self->x_sorted = (self->n > 0 && range.x_sorted)
+                     ? SLOPE_TRUE : SLOPE_FALSE;
+    self->has_finite = range.has_finite;
+}
+
+
+int __slope_xyitem_slot (const slope_xyitem_t *self, int k)
+{
+    if (self->stream == NULL) return k;
+    return __slope_stream_slot(self->stream, k);
+}
+
+
+void __slope_xyitem_map_chunk (slope_item_t *item,
+                               const slope_metrics_t *metrics,
+                               int start, int count, slope_point_t *pts)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    const int slot = __slope_xyitem_slot(self, start);
+
+    /* a chunk that wraps around the end of the ring buffer is
+       mapped as its two contiguous pieces */
+    if (self->stream && slot + count > self->stream->capacity) {
+        const int first = self->stream->capacity - slot;
+        slope_xymetrics_map_xy_batch(metrics, self->vx + slot,
+                                     self->vy + slot, first, pts);
+        slope_xymetrics_map_xy_batch(metrics, self->vx, self->vy,
+                                     count - first, pts + first);
+        return;
+    }
+    if (self->vx == NULL || self->vy == NULL) {
+        double x[SLOPE_XYITEM_CHUNK], y[SLOPE_XYITEM_CHUNK];
+        __slope_dataview_fetch(&self->xview, start, count, x);
+        __slope_dataview_fetch(&self->yview, start, count, y);
+        slope_xymetrics_map_xy_batch(metrics, x, y, count, pts);
+        return;
+    }
+    slope_xymetrics_map_xy_batch(metrics, self->vx + slot,
+                                 self->vy + slot, count, pts);
+}
+
+
+double __slope_xyitem_x_at (const slope_xyitem_t *self, int k)
+{
+    if (self->vx) return self->vx[__slope_xyitem_slot(self, k)];
+    return __slope_dataview_at(&self->xview, k);
+}
+
+
+double __slope_xyitem_y_at (const slope_xyitem_t *self, int k)
+{
+    if (self->vy) return self->vy[__slope_xyitem_slot(self, k)];
+    return __slope_dataview_at(&self->yview, k);
+}
+
+
+int __slope_xyitem_lower_bound (const slope_item_t *item, double x)
+{
+    const slope_xyitem_t *self = (const slope_xyitem_t*) item;
+    int low = 0;
+    int high = self->n;
+    while (low < high) {
+        int mid = low + (high - low)/2;
+        if (__slope_xyitem_x_at(self, mid) < x) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+
+int __slope_xyitem_visible_range (slope_item_t *item,
+                                  const slope_metrics_t *metrics,
+                                  double margin, int *begin, int *end)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->n < 1) return SLOPE_FALSE;
+
+    /* view limits in data space, widened by margin device units */
+    double x1 = slope_xymetrics_unmap_x(metrics, metrics->xmin_figure - margin);
+    double x2 = slope_xymetrics_unmap_x(metrics, metrics->xmax_figure + margin);
+    double y1 = slope_xymetrics_unmap_y(metrics, metrics->ymax_figure + margin);
+    double y2 = slope_xymetrics_unmap_y(metrics, metrics->ymin_figure - margin);
+    if (x2 < x1) {
+        double tmp = x2;
+        x2 = x1;
+        x1 = tmp;
+    }
+    if (y2 < y1) {
+        double tmp = y2;
+        y2 = y1;
+        y1 = tmp;
+    }
+
+    /* skip items whose bounding box misses the view */
+    if (self->xmax < x1 || self->xmin > x2
+        || self->ymax < y1 || self->ymin > y2) {
+        return SLOPE_FALSE;
+    }
+
+    *begin = 0;
+    *end = self->n;
+    if (self->x_sorted) {
+        /* the visible slice plus one neighbour on each side,
+           so lines leaving the view are still drawn */
+        int first = __slope_xyitem_lower_bound(item, x1) - 1;
+        int last = __slope_xyitem_lower_bound(item, x2) + 1;
+        *begin = first < 0 ? 0 : first;
+        *end = last > self->n ? self->n : last;
+    }
+    return *end > *begin;
 }
 
 
@@ -382,5 +829,372 @@ void slope_xyitem_set_antialias (slope_item_t *item, int on)
     slope_item_notify_appearence_change(item);
 }
 
-/* slope/xyitem.c */
 
+void slope_xyitem_set_decimation (slope_item_t *item, int on)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->decimate = on;
+    slope_item_notify_appearence_change(item);
+}
+
+
+void slope_xyitem_set_lod (slope_item_t *item, int on)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->use_lod = on;
+    __slope_xyitem_update_lod(item);
+    slope_item_notify_appearence_change(item);
+}
+
+
+void slope_xyitem_set_symbol_radius (slope_item_t *item, double radius)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->symbol_radius = radius;
+    slope_item_notify_appearence_change(item);
+}
+
+slope_item_t* slope_xyitem_create_stream (int capacity,
+                                          const char *name,
+                                          const char *fmt)
+{
+    slope_stream_t *stream = __slope_stream_create(capacity);
+    if (stream == NULL) {
+        return NULL;
+    }
+    slope_item_t *item = slope_xyitem_create_simple(NULL, NULL, 0, name, fmt);
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->stream = stream;
+    self->vx = stream->vx;
+    self->vy = stream->vy;
+    return item;
+}
+
+
+void slope_xyitem_append (slope_item_t *item, double x, double y)
+{
+    slope_xyitem_append_n(item, &x, &y, 1);
+}
+
+
+void slope_xyitem_append_n (slope_item_t *item,
+                            const double *vx, const double *vy,
+                            const int n)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (n < 1) {
+        return;
+    }
+    if (self->xvec) {
+        slope_vector_append_n(self->xvec, vx, n);
+        slope_vector_append_n(self->yvec, vy, n);
+        slope_xyitem_sync_vectors(item);
+        return;
+    }
+    if (self->stream == NULL) {
+        return;
+    }
+    /* samples that would be pushed out by the same call are skipped */
+    int k = n > self->stream->capacity ? n - self->stream->capacity : 0;
+    for ( ; k<n; k++) {
+        __slope_stream_push(self->stream, vx[k], vy[k]);
+    }
+    self->n = self->stream->count;
+    __slope_xyitem_check_ranges(item);
+    slope_item_notify_data_change(item);
+}
+
+
+void slope_xyitem_clear_stream (slope_item_t *item)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->stream == NULL) {
+        return;
+    }
+    __slope_stream_clear(self->stream);
+    self->n = 0;
+    __slope_xyitem_check_ranges(item);
+    slope_item_notify_data_change(item);
+}
+
+
+slope_item_t* slope_xyitem_create_vectors (slope_vector_t *vx,
+                                           slope_vector_t *vy,
+                                           const char *name,
+                                           const char *fmt)
+{
+    if (vx == NULL || vy == NULL) {
+        return NULL;
+    }
+    slope_item_t *item = slope_xyitem_create_simple(NULL, NULL, 0, name, fmt);
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->xvec = vx;
+    self->yvec = vy;
+    __slope_xyitem_bind_vectors(item);
+    __slope_xyitem_check_ranges(item);
+    __slope_xyitem_update_lod(item);
+    vx->dirty_from = vy->dirty_from = -1;
+    return item;
+}
+
+
+void slope_xyitem_sync_vectors (slope_item_t *item)
+{
+    if (item == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->xvec == NULL) {
+        return;
+    }
+    __slope_xyitem_sync_vectors(item);
+    slope_item_notify_data_change(item);
+}
+
+
+int __slope_xyitem_vectors_changed (const slope_item_t *item)
+{
+    const slope_xyitem_t *self = (const slope_xyitem_t*) item;
+    return self->xvec->dirty_from >= 0 || self->yvec->dirty_from >= 0
+        || self->vx != self->xvec->v || self->vy != self->yvec->v;
+}
+
+
+void __slope_xyitem_sync_vectors (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    const int old_n = self->n;
+    int from = old_n;
+    if (self->xvec->dirty_from >= 0 && self->xvec->dirty_from < from)
+        from = self->xvec->dirty_from;
+    if (self->yvec->dirty_from >= 0 && self->yvec->dirty_from < from)
+        from = self->yvec->dirty_from;
+    __slope_xyitem_bind_vectors(item);
+
+    /* when points were only appended the cached range is merged with
+       that of the new ones, otherwise it is computed again */
+    if (from == old_n && self->n >= old_n && old_n > 0) {
+        slope_range_t range, tail;
+        range.xmin = self->xmin;
+        range.xmax = self->xmax;
+        range.ymin = self->ymin;
+        range.ymax = self->ymax;
+        range.has_finite = self->has_finite;
+        range.x_sorted = self->x_sorted;
+        range.first_x = self->vx[0];
+        range.last_x = self->vx[old_n-1];
+        __slope_range_scan(&tail, self->vx + old_n, self->vy + old_n,
+                           self->n - old_n);
+        if (self->n > old_n) {
+            __slope_range_merge(&range, &tail);
+        }
+        self->xmin = range.xmin;
+        self->xmax = range.xmax;
+        self->ymin = range.ymin;
+        self->ymax = range.ymax;
+        self->has_finite = range.has_finite;
+        self->x_sorted = range.x_sorted;
+    }
+    else {
+        __slope_xyitem_check_ranges(item);
+    }
+
+    if (self->use_lod && self->x_sorted) {
+        __slope_lod_update(&self->lod, &self->yview, self->n,
+                           from < self->n ? from : self->n);
+    }
+    else {
+        __slope_lod_clear(&self->lod);
+    }
+    self->xvec->dirty_from = self->yvec->dirty_from = -1;
+}
+
+
+void __slope_xyitem_bind_vectors (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    self->vx = self->xvec->v;
+    self->vy = self->yvec->v;
+    slope_dataview_init(&self->xview, self->vx, SLOPE_DOUBLE, 0, 0);
+    slope_dataview_init(&self->yview, self->vy, SLOPE_DOUBLE, 0, 0);
+    self->n = self->xvec->size < self->yvec->size
+              ? self->xvec->size : self->yvec->size;
+}
+
+
+void __slope_xyitem_set_doubles (slope_item_t *item,
+                                 const double *vx, const double *vy,
+                                 int n)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    __slope_xyitem_release_data(item);
+    self->vx = vx;
+    self->vy = vy;
+    slope_dataview_init(&self->xview, vx, SLOPE_DOUBLE, 0, 0);
+    slope_dataview_init(&self->yview, vy, SLOPE_DOUBLE, 0, 0);
+    self->n = n;
+}
+
+
+void __slope_xyitem_release_data (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (self->stream == NULL && self->xvec == NULL && self->map == NULL) {
+        return;
+    }
+    __slope_stream_destroy(self->stream);
+    slope_vector_destroy(self->xvec);
+    slope_vector_destroy(self->yvec);
+#if !defined(_WIN32)
+    if (self->map) munmap(self->map, self->map_size);
+#endif
+    self->stream = NULL;
+    self->xvec = self->yvec = NULL;
+    self->map = NULL;
+    self->map_size = 0;
+    self->vx = self->vy = NULL;
+    self->n = 0;
+}
+
+slope_item_t* slope_xyitem_create_views (const slope_dataview_t *x,
+                                         const slope_dataview_t *y,
+                                         const int n,
+                                         const char *name,
+                                         const char *fmt)
+{
+    slope_item_t *item = slope_xyitem_create_simple(NULL, NULL, 0, name, fmt);
+    slope_xyitem_set_views(item, x, y, n);
+    return item;
+}
+
+
+void slope_xyitem_set_views (slope_item_t *item,
+                             const slope_dataview_t *x,
+                             const slope_dataview_t *y,
+                             const int n)
+{
+    if (item == NULL || x == NULL || y == NULL) {
+        return;
+    }
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    __slope_xyitem_release_data(item);
+    self->xview = *x;
+    self->yview = *y;
+    /* plain arrays of doubles keep the direct path */
+    self->vx = __slope_dataview_doubles(x);
+    self->vy = __slope_dataview_doubles(y);
+    self->n = n;
+    __slope_xyitem_check_ranges(item);
+    __slope_xyitem_update_lod(item);
+    slope_item_notify_data_change(item);
+}
+
+slope_item_t* slope_xyitem_create_mapped (const char *path,
+                                          slope_dtype_t type,
+                                          int header, int interleaved,
+                                          const char *name,
+                                          const char *fmt)
+{
+#if defined(_WIN32)
+    (void) path; (void) type; (void) header;
+    (void) interleaved; (void) name; (void) fmt;
+    return NULL;
+#else
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || header < 0 || st.st_size <= header) {
+        close(fd);
+        return NULL;
+    }
+    const size_t size = (size_t) st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const int esize = __slope_dataview_size(type);
+    const int record = interleaved ? 2*esize : esize;
+    size_t count = (size - header) /record;
+    if (count > INT_MAX) count = INT_MAX;
+
+    slope_item_t *item = slope_xyitem_create_simple(NULL, NULL, 0, name, fmt);
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    if (interleaved) {
+        slope_dataview_init(&self->xview, map, type, header, record);
+        slope_dataview_init(&self->yview, map, type, header + esize, record);
+    }
+    else {
+        slope_dataview_init_implicit(&self->xview, 0.0, 1.0);
+        slope_dataview_init(&self->yview, map, type, header, record);
+    }
+    self->vx = __slope_dataview_doubles(&self->xview);
+    self->vy = __slope_dataview_doubles(&self->yview);
+    self->n = (int) count;
+    self->map = map;
+    self->map_size = size;
+
+    /* read the file once, front to back, then leave the pages to the
+       sparse access of drawing */
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+    __slope_xyitem_scan_once(item);
+    posix_madvise(map, size, POSIX_MADV_NORMAL);
+    return item;
+#endif
+}
+
+
+void __slope_xyitem_scan_once (slope_item_t *item)
+{
+    slope_xyitem_t *self = (slope_xyitem_t*) item;
+    double x[SLOPE_XYITEM_SCAN_CHUNK], y[SLOPE_XYITEM_SCAN_CHUNK];
+    slope_lod_builder_t builder;
+    slope_range_t range, part;
+    int start;
+
+    __slope_lod_builder_init(&builder, &self->lod, self->use_lod ? self->n : 0);
+    __slope_range_scan_slice(&range, NULL, NULL, 0);
+    for (start=0; start<self->n; start+=SLOPE_XYITEM_SCAN_CHUNK) {
+        int count = self->n - start;
+        if (count > SLOPE_XYITEM_SCAN_CHUNK) count = SLOPE_XYITEM_SCAN_CHUNK;
+        __slope_dataview_fetch(&self->xview, start, count, x);
+        __slope_dataview_fetch(&self->yview, start, count, y);
+        __slope_range_scan_slice(&part, x, y, count);
+        if (start == 0) range = part;
+        else __slope_range_merge(&range, &part);
+        __slope_lod_builder_feed(&builder, y, start, count);
+    }
+
+    self->xmin = range.xmin;
+    self->xmax = range.xmax;
+    self->ymin = range.ymin;
+    self->ymax = range.ymax;
+    self->has_finite = range.has_finite;
+    self->x_sorted = (self->n > 0 && range.x_sorted)
+                     ? SLOPE_TRUE : SLOPE_FALSE;
+
+    /* the pyramid was built hoping x would turn out sorted */
+    if (self->x_sorted == SLOPE_FALSE) {
+        __slope_lod_clear(&self->lod);
+    }
+}
+
+/* slope/xyitem.c */
@@ -21,6 +21,8 @@
 #define SLOPE_XYDATA_H
 
 #include "slope/item.h"
+#include "slope/vector.h"
+#include "slope/dataview.h"
 
 SLOPE_BEGIN_DECLS
 
@@ -59,11 +61,127 @@ slope_xyitem_update_item (slope_item_t *item,
                           const double *vx, const double *vy,
                           const int n);
 
+/**
+ * @brief Creates an item that reads its n points through the data
+ * views x and y, which may hold floats, int16 or interleaved records,
+ * without copying them. The data are borrowed, as with
+ * slope_xyitem_create_simple().
+ */
+slope_public slope_item_t*
+slope_xyitem_create_views (const slope_dataview_t *x,
+                           const slope_dataview_t *y,
+                           const int n,
+                           const char *name,
+                           const char *fmt);
+
+/**
+ * @brief Creates an item that plots a raw binary file of values of the
+ * given type, after a header of the given size in bytes, by mapping
+ * it into memory. If interleaved, the file holds (x,y) records,
+ * otherwise only y values whose x is their index. The header may be
+ * of any size, values don't need to be aligned. The file is read
+ * once to find the ranges, and then only the parts being drawn.
+ * @return The new item or NULL if the file can't be mapped.
+ */
+slope_public slope_item_t*
+slope_xyitem_create_mapped (const char *path,
+                            slope_dtype_t type,
+                            int header, int interleaved,
+                            const char *name,
+                            const char *fmt);
+
+/**
+ */
+slope_public void
+slope_xyitem_set_views (slope_item_t *item,
+                        const slope_dataview_t *x,
+                        const slope_dataview_t *y,
+                        const int n);
+
 /**
  */
 slope_public void
 slope_xyitem_set_antialias (slope_item_t *item, int on);
 
+/**
+ * @brief Turns on or off min/max-per-pixel-column decimation of line
+ * series. It is on by default and gives the same image as drawing
+ * every point, with at most four points per device pixel column.
+ * Rotated or sheared drawings get every point, and so do recordings,
+ * which may be replayed at any size.
+ */
+slope_public void
+slope_xyitem_set_decimation (slope_item_t *item, int on);
+
+/**
+ * @brief Sets the half width, in device units, of the symbols of
+ * scatter items (3 by default).
+ */
+slope_public void
+slope_xyitem_set_symbol_radius (slope_item_t *item, double radius);
+
+/**
+ * @brief Turns on or off the min/max pyramid kept for large line
+ * series with sorted x. With it, a decimated redraw costs about the
+ * number of pixels instead of the number of visible samples.
+ * It is on by default.
+ */
+slope_public void
+slope_xyitem_set_lod (slope_item_t *item, int on);
+
+/**
+ * @brief Creates an item that owns its data, kept in a ring buffer of
+ * the given capacity. Once the buffer is full, each appended point
+ * pushes the oldest one out.
+ */
+slope_public slope_item_t*
+slope_xyitem_create_stream (int capacity,
+                            const char *name,
+                            const char *fmt);
+
+/**
+ * @brief Creates an item that takes ownership of the vectors vx and
+ * vy, which are destroyed with it. After changing the vectors, call
+ * slope_xyitem_sync_vectors() to notify the figure, the item also
+ * syncs itself when it is next drawn.
+ */
+slope_public slope_item_t*
+slope_xyitem_create_vectors (slope_vector_t *vx,
+                             slope_vector_t *vy,
+                             const char *name,
+                             const char *fmt);
+
+/**
+ * @brief Brings an item created with slope_xyitem_create_vectors()
+ * up to date with its vectors. If they were only appended to, only
+ * the new points are scanned.
+ */
+slope_public void
+slope_xyitem_sync_vectors (slope_item_t *item);
+
+/**
+ * @brief Appends a point to a streaming item, in constant amortized
+ * time regardless of the capacity, or to the vectors of an item
+ * that owns them.
+ */
+slope_public void
+slope_xyitem_append (slope_item_t *item, double x, double y);
+
+/**
+ * @brief Appends n points to a streaming item, notifying the figure
+ * only once.
+ */
+slope_public void
+slope_xyitem_append_n (slope_item_t *item,
+                       const double *vx, const double *vy,
+                       const int n);
+
+/**
+ * @brief Drops every point of a streaming item.
+ */
+slope_public void
+slope_xyitem_clear_stream (slope_item_t *item);
+
 SLOPE_END_DECLS
 
 #endif /*SLOPE_XYDATA_H */
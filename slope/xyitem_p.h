@@ -22,32 +22,98 @@
 
 #include "slope/xyitem.h"
 #include "slope/item_p.h"
+#include "slope/lod_p.h"
+#include "slope/stream_p.h"
+#include "slope/vector.h"
+#include <stddef.h>
 
 SLOPE_BEGIN_DECLS
 
 typedef struct _slope_xyitem slope_xyitem_t;
 
+/**
+ * A symbol pre-rendered to a small image, together with the item
+ * attributes it was rendered with, so it is only rebuilt when they
+ * change.
+ */
+typedef struct _slope_xyitem_sprite slope_xyitem_sprite_t;
+
+struct _slope_xyitem_sprite
+{
+    cairo_pattern_t *pattern;
+    slope_scatter_t  scatter;
+    slope_color_t    color;
+    double           radius;
+    double           line_width;
+    int              fill;
+    int              antialias;
+    int              half;
+    int              size;
+};
+
 struct _slope_xyitem
 {
     slope_item_t    parent;
     int             rescalable;
-    const double   *vx, *vy;
+    const double   *vx, *vy;  /* NULL unless the data are plain doubles */
+    slope_dataview_t xview, yview;
     int             n;
+    slope_stream_t *stream;
+    slope_vector_t *xvec, *yvec;
+    void           *map;
+    size_t          map_size;
+    int             x_sorted;
+    int             has_finite;
     double          xmin, xmax;
     double          ymin, ymax;
     slope_color_t   color;
     slope_scatter_t scatter;
     int             fill_symbol;
+    double          symbol_radius;
+    slope_xyitem_sprite_t sprite;
     int             antialias;
+    int             decimate;
+    int             use_lod;
+    slope_lod_t     lod;
     double          line_width;
 };
 
+/**
+ * State of the min/max-per-column (M4) line decimation. Points are
+ * pushed in user coordinates and, for each run of points falling
+ * on the same device pixel column, only the first, last, minimum and
+ * maximum ones are sent to cairo, in their original order. The
+ * resulting polyline rasterizes to the same pixels as the full one.
+ * Columns only exist when the user to device transform doesn't
+ * rotate or shear, otherwise every point is sent.
+ */
+typedef struct _slope_xyitem_m4 slope_xyitem_m4_t;
+
+struct _slope_xyitem_m4
+{
+    cairo_t       *cr;
+    int            emitted;
+    long           drawn;
+    int            npts;
+    double         column;
+    /* device x = xscale*x + xoffset, when aligned */
+    int            aligned;
+    double         xscale, xoffset;
+    slope_point_t  first, last;
+    slope_point_t  min, max;
+    int            min_seq, max_seq;
+};
+
 /**
  */
 slope_item_class_t* __slope_xyitem_get_class();
 
 void __slope_xyitem_init (slope_item_t *item);
 
+/**
+ */
+void __slope_xyitem_destroy (slope_item_t *item);
+
 /**
  */
 void __slope_xyitem_draw (slope_item_t *item, cairo_t *cr,
@@ -56,28 +122,64 @@ void __slope_xyitem_draw (slope_item_t *item, cairo_t *cr,
 /**
  */
 void __slope_xyitem_draw_line (slope_item_t *item, cairo_t *cr,
-                               const slope_metrics_t *metrics);
+                               const slope_metrics_t *metrics,
+                               int begin, int end);
+
+/**
+ * Draws a decimated line walking the LOD pyramid from the given
+ * level down, only reaching the samples where a block spans more
+ * than one pixel column.
+ */
+void __slope_xyitem_draw_line_lod (slope_item_t *item, slope_xyitem_m4_t *m4,
+                                   const slope_metrics_t *metrics,
+                                   int level, int begin, int end);
+
+/**
+ */
+void __slope_xyitem_lod_push (slope_item_t *item, slope_xyitem_m4_t *m4,
+                              const slope_metrics_t *metrics,
+                              int level, int block, int begin, int end);
 
 /**
  */
-void __slope_xyitem_draw_circles (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics);
+void __slope_xyitem_push_sample (slope_item_t *item, slope_xyitem_m4_t *m4,
+                                 const slope_metrics_t *metrics, int k);
 
 /**
+ * Rebuilds or drops the LOD pyramid after the data changed.
  */
-void __slope_xyitem_draw_triangles (slope_item_t *item, cairo_t *cr,
-                                    const slope_metrics_t *metrics);
+void __slope_xyitem_update_lod (slope_item_t *item);
 
 /**
  */
-void __slope_xyitem_draw_squares (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics);
+void __slope_xyitem_draw_symbols (slope_item_t *item, cairo_t *cr,
+                                  const slope_metrics_t *metrics,
+                                  int begin, int end);
 
 /**
+ * Appends the item's symbol, centered on (x,y), to the current path.
  */
-void __slope_xyitem_draw_plusses (slope_item_t *item, cairo_t *cr,
-                                  const slope_metrics_t *metrics);
+void __slope_xyitem_symbol_path (slope_item_t *item, cairo_t *cr,
+                                 double x, double y);
 
+/**
+ */
+int __slope_xyitem_symbol_filled (const slope_item_t *item);
+
+/**
+ * Returns the cached sprite pattern, rendering it again if any of the
+ * attributes it depends on changed.
+ */
+cairo_pattern_t* __slope_xyitem_get_sprite (slope_item_t *item);
+
+/**
+ */
+void __slope_xyitem_stamp_sprite (slope_item_t *item, cairo_t *cr,
+                                  double x, double y);
+
+/**
+ */
+void __slope_xyitem_clear_sprite (slope_item_t *item);
 
 /**
  */
@@ -88,6 +190,104 @@ void __slope_xyitem_draw_thumb (slope_item_t *item,
  */
 void __slope_xyitem_check_ranges (slope_item_t *item);
 
+/**
+ * Index in vx and vy of the k-th point, which is k itself unless the
+ * item streams its data through a ring buffer.
+ */
+int __slope_xyitem_slot (const slope_xyitem_t *self, int k);
+
+/**
+ * Maps points [start, start+count) to device coordinates, count must
+ * not exceed the size of a drawing chunk.
+ */
+void __slope_xyitem_map_chunk (slope_item_t *item,
+                               const slope_metrics_t *metrics,
+                               int start, int count, slope_point_t *pts);
+
+/**
+ * Coordinates of the k-th point, for the few places that don't go
+ * through __slope_xyitem_map_chunk().
+ */
+double __slope_xyitem_x_at (const slope_xyitem_t *self, int k);
+
+/**
+ */
+double __slope_xyitem_y_at (const slope_xyitem_t *self, int k);
+
+/**
+ */
+void __slope_xyitem_set_doubles (slope_item_t *item,
+                                 const double *vx, const double *vy,
+                                 int n);
+
+/**
+ * Gives the data back to the caller's arrays, dropping the ring
+ * buffer or the vectors the item owned.
+ */
+void __slope_xyitem_release_data (slope_item_t *item);
+
+/**
+ * Computes the ranges and the LOD pyramid in a single sequential pass
+ * over the data, for data that is slow to read, like mapped files.
+ */
+void __slope_xyitem_scan_once (slope_item_t *item);
+
+/**
+ * Tells if the owned vectors were changed or moved since the item
+ * was last synced with them.
+ */
+int __slope_xyitem_vectors_changed (const slope_item_t *item);
+
+/**
+ * Brings the data pointers, ranges and pyramid up to date with the
+ * owned vectors, without notifying the figure.
+ */
+void __slope_xyitem_sync_vectors (slope_item_t *item);
+
+/**
+ * Points vx and vy at the current storage of the owned vectors, which
+ * may have moved since they grew, and clamps n to their sizes.
+ */
+void __slope_xyitem_bind_vectors (slope_item_t *item);
+
+/**
+ * Index of the first point whose x is not less than x, the data
+ * must be sorted in x.
+ */
+int __slope_xyitem_lower_bound (const slope_item_t *item, double x);
+
+/**
+ * Finds the slice [begin, end) of points that must be drawn to cover
+ * the metrics view widened by margin device units. If x is sorted the
+ * slice is found by binary search, otherwise it is the whole data set.
+ * Returns SLOPE_FALSE if the item's bounding box misses the view.
+ */
+int __slope_xyitem_visible_range (slope_item_t *item,
+                                  const slope_metrics_t *metrics,
+                                  double margin, int *begin, int *end);
+
+/**
+ */
+void __slope_xyitem_m4_init (slope_xyitem_m4_t *m4, cairo_t *cr);
+
+/**
+ * Device pixel column of the user space x coordinate.
+ */
+double __slope_xyitem_m4_column (const slope_xyitem_m4_t *m4, double x);
+
+/**
+ */
+void __slope_xyitem_m4_push (slope_xyitem_m4_t *m4, double x, double y);
+
+/**
+ */
+void __slope_xyitem_m4_flush (slope_xyitem_m4_t *m4);
+
+/**
+ */
+void __slope_xyitem_m4_emit (slope_xyitem_m4_t *m4,
+                             const slope_point_t *p);
+
 SLOPE_END_DECLS
 
 #endif /*SLOPE_XYDATA_P_H */
@@ -19,22 +19,28 @@
 
 #include "slope/xymetrics_p.h"
 #include "slope/xyitem_p.h"
+#include "slope/figure_p.h"
 #include "slope/list.h"
 #include <cairo.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+# include <immintrin.h>
+# define SLOPE_XYMETRICS_AVX 1
+#endif
 
 
 slope_metrics_class_t* __slope_xymetrics_get_class()
 {
-    static int first_call = SLOPE_TRUE;
-    static slope_metrics_class_t klass;
-
-    if (first_call) {
-        klass.destroy_fn = __slope_xymetrics_destroy;
-        klass.update_fn = __slope_xymetrics_update;
-        klass.draw_fn = __slope_xymetrics_draw;
-        first_call = SLOPE_FALSE;
-    }
+    static slope_metrics_class_t klass = {
+        __slope_xymetrics_destroy,
+        __slope_xymetrics_update,
+        __slope_xymetrics_draw
+    };
 
     return &klass;
 }
@@ -53,7 +59,14 @@ slope_metrics_t* slope_xymetrics_create()
 
     metrics->x_low_bound = metrics->x_up_bound = 80.0;
     metrics->y_low_bound = metrics->y_up_bound = 45.0;
-
+    metrics->xmin_figure = metrics->xmax_figure = 0.0;
+    metrics->ymin_figure = metrics->ymax_figure = 0.0;
+    metrics->width_figure = metrics->height_figure = 0.0;
+    metrics->revision = 0;
+
+    memset(self->transform_key, 0, sizeof(self->transform_key));
+    __slope_ticks_init(&self->xticks);
+    __slope_ticks_init(&self->yticks);
     self->axis_list = NULL;
     slope_item_t *axis = slope_xyaxis_create(
         metrics, SLOPE_XYAXIS_TOP, "");
@@ -86,6 +99,8 @@ void __slope_xymetrics_destroy (slope_metrics_t *metrics)
         slope_item_destroy(axis);
         slope_iterator_next(&axis_iter);
     }
+    __slope_ticks_destroy(&self->xticks);
+    __slope_ticks_destroy(&self->yticks);
 }
 
 
@@ -93,12 +108,23 @@ void __slope_xymetrics_draw (slope_metrics_t *metrics, cairo_t *cr,
                              const slope_rect_t *rect)
 {
     slope_xymetrics_t *self = (slope_xymetrics_t*) metrics;
-    metrics->xmin_figure = rect->x + metrics->x_low_bound;
-    metrics->ymin_figure = rect->y + metrics->y_low_bound;
-    metrics->xmax_figure = rect->x + rect->width - metrics->x_up_bound;
-    metrics->ymax_figure = rect->y + rect->height - metrics->y_up_bound;
-    metrics->width_figure = metrics->xmax_figure - metrics->xmin_figure;
-    metrics->height_figure = metrics->ymax_figure - metrics->ymin_figure;
+    slope_figure_t *figure = metrics->figure;
+    if (__slope_figure_geometry_frozen(figure) == SLOPE_FALSE) {
+        metrics->xmin_figure = rect->x + metrics->x_low_bound;
+        metrics->ymin_figure = rect->y + metrics->y_low_bound;
+        metrics->xmax_figure = rect->x + rect->width - metrics->x_up_bound;
+        metrics->ymax_figure = rect->y + rect->height - metrics->y_up_bound;
+        metrics->width_figure = metrics->xmax_figure - metrics->xmin_figure;
+        metrics->height_figure = metrics->ymax_figure - metrics->ymin_figure;
+        __slope_xymetrics_update_transform(metrics);
+        __slope_xymetrics_update_revision(metrics);
+        __slope_ticks_update(&self->xticks, self->xmin, self->xmax,
+                             metrics->xmin_figure, self->xscale,
+                             metrics->width_figure, 70.0);
+        __slope_ticks_update(&self->yticks, self->ymin, self->ymax,
+                             metrics->ymax_figure, self->yscale,
+                             metrics->height_figure, 50.0);
+    }
 
     cairo_rectangle(
         cr, metrics->xmin_figure, metrics->ymin_figure,
@@ -113,13 +139,17 @@ void __slope_xymetrics_draw (slope_metrics_t *metrics, cairo_t *cr,
         slope_item_t *item = (slope_item_t*)
             slope_iterator_data(item_iter);
         if (slope_item_get_visible(item)) {
-            __slope_item_draw(item, cr, metrics);
+            double start = __slope_figure_stats_begin(figure);
+            __slope_figure_stats_item_begin(figure, item);
+            __slope_item_draw_layer(item, cr, metrics);
+            __slope_figure_stats_item_end(figure, start);
         }
         slope_iterator_next(&item_iter);
     }
     cairo_restore(cr);
 
     /* draw axis */
+    double axis_start = __slope_figure_stats_begin(figure);
     slope_iterator_t *axis_iter =
     slope_list_first(self->axis_list);
     while (axis_iter) {
@@ -130,47 +160,57 @@ void __slope_xymetrics_draw (slope_metrics_t *metrics, cairo_t *cr,
         }
         slope_iterator_next(&axis_iter);
     }
+    __slope_figure_stats_end(figure, axis_time, axis_start);
 }
 
 
 void __slope_xymetrics_update (slope_metrics_t *metrics)
 {
     slope_xymetrics_t *self = (slope_xymetrics_t*) metrics;
-    if (metrics->item_list == NULL) {
+    int found = SLOPE_FALSE;
+
+    /* items without a single finite point have no range to offer */
+    slope_iterator_t *iter = slope_list_first(metrics->item_list);
+    while (iter) {
+        slope_xyitem_t *item = (slope_xyitem_t*) slope_iterator_data(iter);
+        slope_iterator_next(&iter);
+        if (item->rescalable == SLOPE_FALSE
+                || item->has_finite == SLOPE_FALSE) {
+            continue;
+        }
+        if (found == SLOPE_FALSE) {
+            self->xmin = item->xmin;
+            self->xmax = item->xmax;
+            self->ymin = item->ymin;
+            self->ymax = item->ymax;
+            found = SLOPE_TRUE;
+            continue;
+        }
+        if (item->xmin < self->xmin) self->xmin = item->xmin;
+        if (item->xmax > self->xmax) self->xmax = item->xmax;
+        if (item->ymin < self->ymin) self->ymin = item->ymin;
+        if (item->ymax > self->ymax) self->ymax = item->ymax;
+    }
+    if (found == SLOPE_FALSE) {
         self->xmin = 0.0;
         self->xmax = 1.0;
         self->ymin = 0.0;
         self->ymax = 1.0;
         self->width = self->xmax - self->xmin;
         self->height = self->ymax - self->ymin;
+        __slope_xymetrics_update_transform(metrics);
+        __slope_figure_touch(metrics->figure);
         return;
     }
 
-    slope_iterator_t *iter = slope_list_first(metrics->item_list);
-    slope_xyitem_t *item = (slope_xyitem_t*) slope_iterator_data(iter);
-
-    while (item->rescalable == SLOPE_FALSE) {
-        slope_iterator_next(&iter);
-        item = (slope_xyitem_t*) slope_iterator_data(iter);
+    /* a single point or a constant series still needs a scale */
+    if (self->xmax == self->xmin) {
+        self->xmin -= 0.5;
+        self->xmax += 0.5;
     }
-
-    self->xmin = item->xmin;
-    self->xmax = item->xmax;
-    self->ymin = item->ymin;
-    self->ymax = item->ymax;
-
-    slope_iterator_next(&iter);
-    while (iter) {
-        item = (slope_xyitem_t*) slope_iterator_data(iter);
-        if (item->rescalable == SLOPE_FALSE) {
-            slope_iterator_next(&iter);
-            continue;
-        }
-        if (item->xmin < self->xmin) self->xmin = item->xmin;
-        if (item->xmax > self->xmax) self->xmax = item->xmax;
-        if (item->ymin < self->ymin) self->ymin = item->ymin;
-        if (item->ymax > self->ymax) self->ymax = item->ymax;
-        slope_iterator_next(&iter);
+    if (self->ymax == self->ymin) {
+        self->ymin -= 0.5;
+        self->ymax += 0.5;
     }
     double xbound = (self->xmax - self->xmin) /20.0;
     self->xmin -= xbound;
@@ -180,22 +220,116 @@ void __slope_xymetrics_update (slope_metrics_t *metrics)
     self->ymax += ybound;
     self->width = self->xmax - self->xmin;
     self->height = self->ymax - self->ymin;
+    __slope_xymetrics_update_transform(metrics);
+    __slope_figure_touch(metrics->figure);
+}
+
+
+void __slope_xymetrics_update_transform (slope_metrics_t *metrics)
+{
+    slope_xymetrics_t *self = (slope_xymetrics_t*) metrics;
+    self->xscale = metrics->width_figure /self->width;
+    self->yscale = - metrics->height_figure /self->height;
+}
+
+
+void __slope_xymetrics_update_revision (slope_metrics_t *metrics)
+{
+    slope_xymetrics_t *self = (slope_xymetrics_t*) metrics;
+    double key[6];
+    key[0] = self->xmin;
+    key[1] = self->ymin;
+    key[2] = self->xscale;
+    key[3] = self->yscale;
+    key[4] = metrics->xmin_figure;
+    key[5] = metrics->ymin_figure;
+    if (memcmp(key, self->transform_key, sizeof(key)) != 0) {
+        memcpy(self->transform_key, key, sizeof(key));
+        metrics->revision += 1;
+    }
 }
 
 
 double slope_xymetrics_map_x (const slope_metrics_t *metrics, double x)
 {
     const slope_xymetrics_t *self = (const slope_xymetrics_t*) metrics;
-    double tmp = (x - self->xmin) /self->width;
-    return metrics->xmin_figure + tmp*metrics->width_figure;
+    return (x - self->xmin)*self->xscale + metrics->xmin_figure;
 }
 
 
 double slope_xymetrics_map_y (const slope_metrics_t *metrics, double y)
 {
     const slope_xymetrics_t *self = (const slope_xymetrics_t*) metrics;
-    double tmp = (y - self->ymin) /self->height;
-    return metrics->ymax_figure - tmp*metrics->height_figure;
+    return (y - self->ymin)*self->yscale + metrics->ymax_figure;
+}
+
+
+#if defined(SLOPE_XYMETRICS_AVX)
+__attribute__((target("avx")))
+static int __slope_xymetrics_map_xy_avx (const slope_metrics_t *metrics,
+                                         const double *vx, const double *vy,
+                                         int n, slope_point_t *out)
+{
+    const slope_xymetrics_t *self = (const slope_xymetrics_t*) metrics;
+    const __m256d x0 = _mm256_set1_pd(self->xmin);
+    const __m256d y0 = _mm256_set1_pd(self->ymin);
+    const __m256d xs = _mm256_set1_pd(self->xscale);
+    const __m256d ys = _mm256_set1_pd(self->yscale);
+    const __m256d xf = _mm256_set1_pd(metrics->xmin_figure);
+    const __m256d yf = _mm256_set1_pd(metrics->ymax_figure);
+    double *dst = (double*) out;
+    int k;
+    for (k=0; k+4<=n; k+=4) {
+        __m256d x = _mm256_loadu_pd(vx+k);
+        __m256d y = _mm256_loadu_pd(vy+k);
+        x = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(x, x0), xs), xf);
+        y = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(y, y0), ys), yf);
+        /* interleave to x0 y0 x1 y1 | x2 y2 x3 y3 */
+        __m256d lo = _mm256_unpacklo_pd(x, y);
+        __m256d hi = _mm256_unpackhi_pd(x, y);
+        _mm256_storeu_pd(dst + 2*k, _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(dst + 2*k + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+    return k;
+}
+#endif
+
+
+void slope_xymetrics_map_xy_batch (const slope_metrics_t *metrics,
+                                   const double *vx, const double *vy,
+                                   int n, slope_point_t *out)
+{
+    const slope_xymetrics_t *self = (const slope_xymetrics_t*) metrics;
+    int k = 0;
+
+#if defined(SLOPE_XYMETRICS_AVX)
+    if (__builtin_cpu_supports("avx")) {
+        k = __slope_xymetrics_map_xy_avx(metrics, vx, vy, n, out);
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128d x0 = _mm_set1_pd(self->xmin);
+        const __m128d y0 = _mm_set1_pd(self->ymin);
+        const __m128d xs = _mm_set1_pd(self->xscale);
+        const __m128d ys = _mm_set1_pd(self->yscale);
+        const __m128d xf = _mm_set1_pd(metrics->xmin_figure);
+        const __m128d yf = _mm_set1_pd(metrics->ymax_figure);
+        double *dst = (double*) out;
+        for (; k+2<=n; k+=2) {
+            __m128d x = _mm_loadu_pd(vx+k);
+            __m128d y = _mm_loadu_pd(vy+k);
+            x = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(x, x0), xs), xf);
+            y = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(y, y0), ys), yf);
+            _mm_storeu_pd(dst + 2*k, _mm_unpacklo_pd(x, y));
+            _mm_storeu_pd(dst + 2*k + 2, _mm_unpackhi_pd(x, y));
+        }
+    }
+#endif
+    for (; k<n; k++) {
+        out[k].x = (vx[k] - self->xmin)*self->xscale + metrics->xmin_figure;
+        out[k].y = (vy[k] - self->ymin)*self->yscale + metrics->ymax_figure;
+    }
 }
 
 
@@ -266,6 +400,8 @@ void slope_xymetrics_set_x_range (slope_metrics_t *metrics,
     self->xmin = xi;
     self->xmax = xf;
     self->width = self->xmax - self->xmin;
+    __slope_xymetrics_update_transform(metrics);
+    __slope_figure_touch(metrics->figure);
 }
 
 
@@ -279,6 +415,8 @@ void slope_xymetrics_set_y_range (slope_metrics_t *metrics,
     self->ymin = yi;
     self->ymax = yf;
     self->height = self->ymax - self->ymin;
+    __slope_xymetrics_update_transform(metrics);
+    __slope_figure_touch(metrics->figure);
 }
 
 /* slope/xymetrics.h */
@@ -39,6 +39,18 @@ slope_xymetrics_map_x (const slope_metrics_t *metrics, double x);
 slope_public double
 slope_xymetrics_map_y (const slope_metrics_t *metrics, double y);
 
+/**
+ * @brief Maps n data points to figure coordinates at once.
+ *
+ * out[k] receives the figure coordinates of (vx[k], vy[k]). This is
+ * the same transformation as slope_xymetrics_map_x() and
+ * slope_xymetrics_map_y(), using SIMD instructions where available.
+ */
+slope_public void
+slope_xymetrics_map_xy_batch (const slope_metrics_t *metrics,
+                              const double *vx, const double *vy,
+                              int n, slope_point_t *out);
+
 /**
  */
 slope_public double
@@ -22,6 +22,7 @@
 
 #include "slope/xymetrics.h"
 #include "slope/metrics_p.h"
+#include "slope/ticks_p.h"
 
 SLOPE_BEGIN_DECLS
 
@@ -40,6 +41,14 @@ struct _slope_xymetrics
     double xmin, xmax;
     double ymin, ymax;
     double width, height;
+    /* data to figure transform, X = (x - xmin)*xscale + xmin_figure
+       and Y = (y - ymin)*yscale + ymax_figure */
+    double xscale, yscale;
+    /* the transform and plot area the revision refers to */
+    double transform_key[6];
+    /* ticks shared by the top and bottom, and by the left and
+       right axes */
+    slope_ticks_t xticks, yticks;
 };
 
 
@@ -48,6 +57,13 @@ struct _slope_xymetrics
 slope_metrics_class_t* __slope_xymetrics_get_class();
 
 
+/**
+ * Bumps the metrics revision if the transform differs from the one
+ * of the last draw, changes in between don't count.
+ */
+void __slope_xymetrics_update_revision (slope_metrics_t *metrics);
+
+
 /**
  */
 void __slope_xymetrics_destroy (slope_metrics_t *metrics);
@@ -62,6 +78,12 @@ void __slope_xymetrics_draw (slope_metrics_t *metrics, cairo_t *cr,
  */
 void __slope_xymetrics_update (slope_metrics_t *metrics);
 
+/**
+ * Recomputes the data to figure scale factors, must be called
+ * whenever the data ranges or the figure geometry change.
+ */
+void __slope_xymetrics_update_transform (slope_metrics_t *metrics);
+
 SLOPE_END_DECLS
 
 #endif /*SLOPE_XYMETRICS_P_H */
@@ -0,0 +1,227 @@
+/*
+ * Draws a long line series through the plain and the LOD pyramid
+ * decimation paths, and without decimation, checking the number of
+ * points sent to cairo and that both decimation paths paint the same
+ * pixels, also on a hi-DPI surface and a rotated context, and into
+ * a recording. A line whose vectors grew without being synced is
+ * drawn too.
+ */
+
+#include "slope/slope.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cairo.h>
+
+#define NPTS   200000
+#define NGAPS  3
+#define WIDTH  400
+#define HEIGHT 300
+
+
+static double vx[NPTS], vy[NPTS];
+static int failures = 0;
+
+#define CHECK(cond, what) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, what); \
+            failures++; \
+        } \
+    } while (0)
+
+
+typedef struct
+{
+    cairo_surface_t *surf;
+    long points_in;
+    long points_drawn;
+}
+drawing_t;
+
+
+static void count_points (slope_figure_t *figure, slope_item_t *item,
+                          drawing_t *out)
+{
+    const slope_figure_stats_t *stats = slope_figure_get_stats(figure);
+    int k;
+
+    out->points_in = out->points_drawn = -1;
+    for (k=0; stats && k<stats->nitems; k++) {
+        if (stats->items[k].item == item) {
+            out->points_in = stats->items[k].points_in;
+            out->points_drawn = stats->items[k].points_drawn;
+        }
+    }
+}
+
+
+static void draw (slope_figure_t *figure, slope_item_t *item,
+                  double scale, double angle, drawing_t *out)
+{
+    slope_rect_t rect;
+
+    out->surf = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, (int) (WIDTH*scale), (int) (HEIGHT*scale));
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 14, 0)
+    cairo_surface_set_device_scale(out->surf, scale, scale);
+#endif
+    cairo_t *cr = cairo_create(out->surf);
+    if (angle != 0.0) {
+        cairo_rotate(cr, angle);
+    }
+    slope_rect_set(&rect, 0.0, 0.0, WIDTH, HEIGHT);
+    slope_figure_draw(figure, cr, &rect);
+    cairo_destroy(cr);
+    cairo_surface_flush(out->surf);
+    count_points(figure, item, out);
+}
+
+
+static int same_pixels (cairo_surface_t *a, cairo_surface_t *b)
+{
+    const int height = cairo_image_surface_get_height(a);
+    const int stride = cairo_image_surface_get_stride(a);
+    return height == cairo_image_surface_get_height(b)
+        && stride == cairo_image_surface_get_stride(b)
+        && memcmp(cairo_image_surface_get_data(a),
+                  cairo_image_surface_get_data(b),
+                  (size_t) height*stride) == 0;
+}
+
+
+static void check_scale (slope_figure_t *figure, slope_item_t *item,
+                         double scale)
+{
+    /* samples in the same device pixel column are reduced to 4 */
+    const long max_drawn = (long) (4*(WIDTH*scale + 2));
+    drawing_t lod, plain, full;
+
+    slope_xyitem_set_decimation(item, SLOPE_TRUE);
+    slope_xyitem_set_lod(item, SLOPE_TRUE);
+    draw(figure, item, scale, 0.0, &lod);
+    slope_xyitem_set_lod(item, SLOPE_FALSE);
+    draw(figure, item, scale, 0.0, &plain);
+    slope_xyitem_set_decimation(item, SLOPE_FALSE);
+    draw(figure, item, scale, 0.0, &full);
+
+    CHECK(lod.points_in == NPTS, "not all points are in view");
+    CHECK(full.points_drawn == NPTS - NGAPS,
+          "undecimated line skipped finite points");
+    CHECK(plain.points_drawn > 0 && plain.points_drawn <= max_drawn,
+          "more than 4 points per device column");
+    CHECK(lod.points_drawn == plain.points_drawn,
+          "pyramid and plain decimation drew different points");
+    CHECK(same_pixels(lod.surf, plain.surf),
+          "pyramid and plain decimation painted different pixels");
+
+    cairo_surface_destroy(lod.surf);
+    cairo_surface_destroy(plain.surf);
+    cairo_surface_destroy(full.surf);
+}
+
+
+/* the item starts with a small pyramid, then the vectors grow past it
+   and the figure is redrawn before slope_xyitem_sync_vectors() */
+static void check_unsynced_append (void)
+{
+    const int first = 8192;
+    slope_vector_t *xvec = slope_vector_create(0);
+    slope_vector_t *yvec = slope_vector_create(0);
+    drawing_t before, after;
+    int k;
+
+    CHECK(slope_vector_append_n(xvec, vx, first) == SLOPE_SUCCESS
+          && slope_vector_append_n(yvec, vy, first) == SLOPE_SUCCESS,
+          "vector append failed");
+    slope_figure_t *figure = slope_figure_create();
+    slope_metrics_t *metrics = slope_xymetrics_create();
+    slope_item_t *item = slope_xyitem_create_vectors(xvec, yvec,
+                                                     "growing", "b-");
+    slope_figure_add_metrics(figure, metrics);
+    slope_metrics_add_item(metrics, item);
+    slope_figure_set_use_layers(figure, SLOPE_FALSE);
+    slope_figure_set_stats_enabled(figure, SLOPE_TRUE);
+    slope_xyitem_set_decimation(item, SLOPE_TRUE);
+    slope_xyitem_set_lod(item, SLOPE_TRUE);
+    draw(figure, item, 1.0, 0.0, &before);
+
+    for (k=first; k<NPTS; k++) {
+        slope_vector_append(xvec, vx[k]);
+        slope_vector_append(yvec, vy[k]);
+    }
+    slope_xymetrics_set_x_range(metrics, 0.0, NPTS);
+    draw(figure, item, 1.0, 0.0, &after);
+    CHECK(before.points_in == first, "not all points are in view");
+    CHECK(after.points_in == NPTS, "appended points were not drawn");
+    CHECK(after.points_drawn > 0 && after.points_drawn <= 4*(WIDTH + 2),
+          "appended points were not decimated");
+
+    cairo_surface_destroy(before.surf);
+    cairo_surface_destroy(after.surf);
+    slope_chart_destroy(figure);
+}
+
+
+int main (void)
+{
+    drawing_t rotated;
+    int k;
+
+    /* a noisy sine with a few gaps */
+    srand(7);
+    for (k=0; k<NPTS; k++) {
+        vx[k] = k;
+        vy[k] = sin(k*2e-4) + 0.1*((double) rand()/RAND_MAX - 0.5);
+    }
+    for (k=0; k<NGAPS; k++) {
+        vy[(k + 1)*(NPTS/(NGAPS + 1))] = NAN;
+    }
+
+    slope_figure_t *figure = slope_figure_create();
+    slope_metrics_t *metrics = slope_xymetrics_create();
+    slope_item_t *item = slope_xyitem_create_simple(vx, vy, NPTS,
+                                                    "noisy sine", "b-");
+    slope_figure_add_metrics(figure, metrics);
+    slope_metrics_add_item(metrics, item);
+    /* every draw runs the item's draw function */
+    slope_figure_set_use_layers(figure, SLOPE_FALSE);
+    slope_figure_set_stats_enabled(figure, SLOPE_TRUE);
+
+    check_scale(figure, item, 1.0);
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 14, 0)
+    check_scale(figure, item, 2.0);
+
+    /* twice the device columns keep more points */
+    drawing_t low, high;
+    slope_xyitem_set_decimation(item, SLOPE_TRUE);
+    draw(figure, item, 1.0, 0.0, &low);
+    draw(figure, item, 2.0, 0.0, &high);
+    CHECK(high.points_drawn > low.points_drawn,
+          "a hi-DPI surface kept no more points");
+    cairo_surface_destroy(low.surf);
+    cairo_surface_destroy(high.surf);
+#endif
+
+    /* a rotated line has no pixel columns to reduce */
+    slope_xyitem_set_decimation(item, SLOPE_TRUE);
+    draw(figure, item, 1.0, 0.1, &rotated);
+    CHECK(rotated.points_drawn == NPTS - NGAPS,
+          "rotated line was decimated");
+    cairo_surface_destroy(rotated.surf);
+
+    /* a recording may be replayed larger than it was recorded */
+    drawing_t recorded;
+    slope_recording_t *recording = slope_figure_record(figure, WIDTH, HEIGHT);
+    count_points(figure, item, &recorded);
+    CHECK(recording != NULL, "recording failed");
+    CHECK(recorded.points_drawn == NPTS - NGAPS,
+          "recorded line was decimated");
+    slope_recording_destroy(recording);
+
+    slope_chart_destroy(figure);
+
+    check_unsynced_append();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
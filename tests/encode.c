@@ -0,0 +1,342 @@
+/*
+ * Encodes a small ARGB32 image with slope_image_encode() in every
+ * native format and decodes the output again, checking it gives the
+ * straight alpha pixels back.
+ */
+
+#include "slope/slope.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(SLOPE_HAVE_ZLIB)
+# include <zlib.h>
+#endif
+
+#define WIDTH  37
+#define HEIGHT 23
+
+
+typedef struct
+{
+    unsigned char *data;
+    size_t len, nalloc;
+}
+output_t;
+
+
+static int failures = 0;
+
+#define CHECK(cond, what) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, what); \
+            failures++; \
+            return; \
+        } \
+    } while (0)
+
+
+static int collect (void *closure, const unsigned char *data,
+                    unsigned int length)
+{
+    output_t *out = (output_t*) closure;
+    if (out->len + length > out->nalloc) {
+        size_t nalloc = 2*(out->len + length);
+        unsigned char *grown = realloc(out->data, nalloc);
+        if (grown == NULL) return SLOPE_ERROR;
+        out->data = grown;
+        out->nalloc = nalloc;
+    }
+    memcpy(out->data + out->len, data, length);
+    out->len += length;
+    return SLOPE_SUCCESS;
+}
+
+
+static uint32_t be32 (const unsigned char *p)
+{
+    return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16
+         | (uint32_t) p[2] << 8 | (uint32_t) p[3];
+}
+
+
+static uint32_t crc32_of (const unsigned char *p, size_t len)
+{
+    uint32_t crc = 0xffffffffu;
+    size_t k;
+    int bit;
+    for (k=0; k<len; k++) {
+        crc ^= p[k];
+        for (bit=0; bit<8; bit++) {
+            crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+        }
+    }
+    return crc ^ 0xffffffffu;
+}
+
+
+/* premultiplied native endian words, with transparent, translucent
+   and opaque pixels, and a plain band longer than a QOI run */
+static void make_image (uint32_t *px, unsigned char *rgba)
+{
+    int x, y;
+    for (y=0; y<HEIGHT; y++) {
+        for (x=0; x<WIDTH; x++) {
+            uint32_t a = (x + y) % 11 == 0 ? 0 : (x*7 + y) % 5 == 0 ? 0x80 : 0xff;
+            uint32_t r = (x*9) & 0xff, g = (y*11) & 0xff, b = ((x + y)*3) & 0xff;
+            if (y >= HEIGHT - 4) {
+                a = 0xff;
+                r = g = b = 0x40;
+            }
+            unsigned char *dst = rgba + 4*(y*WIDTH + x);
+            r = (r*a + 127) / 255;
+            g = (g*a + 127) / 255;
+            b = (b*a + 127) / 255;
+            px[y*WIDTH + x] = a << 24 | r << 16 | g << 8 | b;
+            if (a != 0 && a != 0xff) {
+                r = (r*255 + a/2) / a;
+                g = (g*255 + a/2) / a;
+                b = (b*255 + a/2) / a;
+            }
+            dst[0] = (unsigned char) r;
+            dst[1] = (unsigned char) g;
+            dst[2] = (unsigned char) b;
+            dst[3] = (unsigned char) a;
+        }
+    }
+}
+
+
+static int encode (const uint32_t *px, slope_format_t format, int level,
+                   output_t *out)
+{
+    slope_export_options_t options;
+    slope_export_options_init(&options);
+    options.png_level = level;
+    options.png_filter = SLOPE_PNG_FILTER_ADAPTIVE;
+    out->len = 0;
+    return slope_image_encode((const unsigned char*) px, WIDTH, HEIGHT,
+                              4*WIDTH, format, &options, collect, out);
+}
+
+
+/* the zlib stream of stored blocks written without zlib */
+static size_t inflate_stored (const unsigned char *z, size_t zlen,
+                              unsigned char *dst, size_t size)
+{
+    size_t pos = 2, len = 0;
+    uint32_t a = 1, b = 0;
+    int last = 0;
+    while (!last && pos + 5 <= zlen) {
+        size_t n = z[pos+1] | z[pos+2] << 8;
+        last = z[pos] & 1;
+        if ((z[pos] & 6) != 0 || (n ^ (z[pos+3] | z[pos+4] << 8)) != 0xffff
+                || pos + 5 + n > zlen || len + n > size) {
+            return 0;
+        }
+        memcpy(dst + len, z + pos + 5, n);
+        len += n;
+        pos += 5 + n;
+    }
+    size_t k;
+    for (k=0; k<len; k++) {
+        a = (a + dst[k]) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (!last || pos + 4 != zlen || be32(z + pos) != (b << 16 | a)) return 0;
+    return len;
+}
+
+
+static int paeth (int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+
+static void check_png (const uint32_t *px, const unsigned char *rgba,
+                       int level)
+{
+    static const unsigned char signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    const size_t rowlen = 4*WIDTH + 1;
+    unsigned char raw[HEIGHT*(4*WIDTH + 1)];
+    unsigned char *idat = NULL;
+    size_t idat_len = 0, pos = 8, len = 0;
+    int seen_end = 0, x, y;
+    output_t out = { NULL, 0, 0 };
+
+    CHECK(encode(px, SLOPE_FORMAT_PNG, level, &out) == SLOPE_SUCCESS,
+          "PNG encoding failed");
+    CHECK(out.len > 8 && memcmp(out.data, signature, 8) == 0,
+          "bad PNG signature");
+    while (pos + 12 <= out.len && !seen_end) {
+        size_t n = be32(out.data + pos);
+        const unsigned char *type = out.data + pos + 4;
+        CHECK(pos + 12 + n <= out.len, "truncated PNG chunk");
+        CHECK(crc32_of(type, n + 4) == be32(type + 4 + n), "bad PNG CRC");
+        if (memcmp(type, "IHDR", 4) == 0) {
+            CHECK(n == 13 && be32(type + 4) == WIDTH
+                  && be32(type + 8) == HEIGHT && type[12] == 8
+                  && type[13] == 6, "bad IHDR");
+        }
+        else if (memcmp(type, "IDAT", 4) == 0) {
+            idat = realloc(idat, idat_len + n);
+            memcpy(idat + idat_len, type + 4, n);
+            idat_len += n;
+        }
+        else if (memcmp(type, "IEND", 4) == 0) {
+            seen_end = 1;
+        }
+        pos += 12 + n;
+    }
+    CHECK(seen_end && pos == out.len, "PNG doesn't end with IEND");
+
+    len = inflate_stored(idat, idat_len, raw, sizeof(raw));
+#if defined(SLOPE_HAVE_ZLIB)
+    if (len == 0) {
+        uLongf size = sizeof(raw);
+        if (uncompress(raw, &size, idat, idat_len) == Z_OK) len = size;
+    }
+#endif
+    free(idat);
+    free(out.data);
+    CHECK(len == sizeof(raw), "PNG data doesn't inflate to the image");
+
+    for (y=0; y<HEIGHT; y++) {
+        unsigned char *row = raw + y*rowlen + 1;
+        const unsigned char *prev = y > 0 ? row - rowlen : NULL;
+        const int filter = row[-1];
+        CHECK(filter <= 4, "bad PNG filter type");
+        for (x=0; x<4*WIDTH; x++) {
+            int a = x >= 4 ? row[x-4] : 0;
+            int b = prev ? prev[x] : 0;
+            int c = prev && x >= 4 ? prev[x-4] : 0;
+            int add = filter == 1 ? a : filter == 2 ? b
+                    : filter == 3 ? (a + b)/2 : filter == 4 ? paeth(a, b, c) : 0;
+            row[x] = (unsigned char) (row[x] + add);
+        }
+        CHECK(memcmp(row, rgba + 4*y*WIDTH, 4*WIDTH) == 0,
+              "PNG pixels differ from the image");
+    }
+}
+
+
+static void check_qoi (const uint32_t *px, const unsigned char *rgba)
+{
+    static const unsigned char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    unsigned char index[64][4], pixel[4] = { 0, 0, 0, 255 };
+    output_t out = { NULL, 0, 0 };
+    size_t pos = 14;
+    int k = 0, run = 0;
+
+    CHECK(encode(px, SLOPE_FORMAT_QOI, 0, &out) == SLOPE_SUCCESS,
+          "QOI encoding failed");
+    CHECK(out.len >= 22 && memcmp(out.data, "qoif", 4) == 0
+          && be32(out.data + 4) == WIDTH && be32(out.data + 8) == HEIGHT
+          && out.data[12] == 4, "bad QOI header");
+    CHECK(memcmp(out.data + out.len - 8, padding, 8) == 0,
+          "bad QOI end marker");
+    memset(index, 0, sizeof(index));
+
+    for (k=0; k<WIDTH*HEIGHT; k++) {
+        if (run > 0) {
+            run--;
+        }
+        else {
+            CHECK(pos < out.len - 8, "truncated QOI data");
+            const unsigned char op = out.data[pos++];
+            if (op == 0xfe) {
+                memcpy(pixel, out.data + pos, 3);
+                pos += 3;
+            }
+            else if (op == 0xff) {
+                memcpy(pixel, out.data + pos, 4);
+                pos += 4;
+            }
+            else if ((op >> 6) == 0) {
+                memcpy(pixel, index[op], 4);
+            }
+            else if ((op >> 6) == 1) {
+                pixel[0] += ((op >> 4) & 3) - 2;
+                pixel[1] += ((op >> 2) & 3) - 2;
+                pixel[2] += (op & 3) - 2;
+            }
+            else if ((op >> 6) == 2) {
+                const int dg = (op & 0x3f) - 32;
+                const unsigned char next = out.data[pos++];
+                pixel[0] += dg + (next >> 4) - 8;
+                pixel[1] += dg;
+                pixel[2] += dg + (next & 0x0f) - 8;
+            }
+            else {
+                run = op & 0x3f;
+            }
+            memcpy(index[(pixel[0]*3 + pixel[1]*5 + pixel[2]*7
+                          + pixel[3]*11) % 64], pixel, 4);
+        }
+        CHECK(memcmp(pixel, rgba + 4*k, 4) == 0,
+              "QOI pixels differ from the image");
+    }
+    CHECK(pos == out.len - 8 && run == 0, "QOI data after the last pixel");
+    free(out.data);
+}
+
+
+static void check_pnm (const uint32_t *px, const unsigned char *rgba,
+                       int alpha)
+{
+    output_t out = { NULL, 0, 0 };
+    const int depth = alpha ? 4 : 3;
+    char head[128];
+    int k;
+
+    CHECK(encode(px, alpha ? SLOPE_FORMAT_PAM : SLOPE_FORMAT_PPM, 0, &out)
+          == SLOPE_SUCCESS, "PPM/PAM encoding failed");
+    if (alpha) {
+        sprintf(head, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\n"
+                      "TUPLTYPE RGB_ALPHA\nENDHDR\n", WIDTH, HEIGHT);
+    }
+    else {
+        sprintf(head, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+    }
+    const size_t hlen = strlen(head);
+    CHECK(out.len == hlen + (size_t) depth*WIDTH*HEIGHT
+          && memcmp(out.data, head, hlen) == 0, "bad PPM/PAM header");
+    for (k=0; k<WIDTH*HEIGHT; k++) {
+        CHECK(memcmp(out.data + hlen + depth*k, rgba + 4*k, depth) == 0,
+              "PPM/PAM pixels differ from the image");
+    }
+    free(out.data);
+}
+
+
+int main (void)
+{
+    static uint32_t px[WIDTH*HEIGHT];
+    static unsigned char rgba[4*WIDTH*HEIGHT];
+    output_t out = { NULL, 0, 0 };
+
+    make_image(px, rgba);
+    check_png(px, rgba, 0);
+    check_png(px, rgba, 6);
+    check_png(px, rgba, 9);
+    check_qoi(px, rgba);
+    check_pnm(px, rgba, 0);
+    check_pnm(px, rgba, 1);
+
+    /* formats cairo writes itself are refused here */
+    if (encode(px, SLOPE_FORMAT_PDF, 0, &out) != SLOPE_ERROR) {
+        fprintf(stderr, "PDF pixels were accepted\n");
+        failures++;
+    }
+    free(out.data);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}